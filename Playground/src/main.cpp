@@ -1,9 +1,11 @@
 #include <iostream>
 
+#ifdef _WIN32
 #include <GLFW/glfw3.h>
 
 #define GLFW_EXPOSE_NATIVE_WIN32
 #include <GLFW/glfw3native.h>
+#endif
 
 #include <Forge.h>
 #include <ForgeLogger.h>
@@ -19,10 +21,13 @@
 
 #include <sstream>
 #include <fstream>
+#include <chrono>
+#include <cstring>
 
 static uint32_t width = 800;
 static uint32_t height = 600;
 
+#ifdef _WIN32
 inline static void
 _glfw_error_callback(int error, const char* description)
 {
@@ -35,6 +40,7 @@ _glfw_window_size_callback(GLFWwindow* window, int _width, int _height)
 	width = _width;
 	height = _height;
 }
+#endif
 
 inline static std::string
 _shader_code_read(const char* path)
@@ -58,8 +64,124 @@ _shader_code_read(const char* path)
 	return source_code.str();
 }
 
-int main()
+inline static forge::ForgePipelineDescription
+_pipeline_description()
 {
+	forge::ForgePipelineDescription pipeline_desc {};
+	pipeline_desc.bindings[0].binding = 0u;
+	pipeline_desc.bindings[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+	pipeline_desc.bindings[0].stride = 3 * sizeof(float);
+	pipeline_desc.blend_desc[0].blendEnable = true;
+	pipeline_desc.blend_desc[0].colorBlendOp = VK_BLEND_OP_ADD;
+	pipeline_desc.blend_desc[0].alphaBlendOp = VK_BLEND_OP_ADD;
+	pipeline_desc.blend_desc[0].srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+	pipeline_desc.blend_desc[0].dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	pipeline_desc.blend_desc[0].srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+	pipeline_desc.blend_desc[0].dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+	pipeline_desc.blend_desc[0].colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
+												 VK_COLOR_COMPONENT_G_BIT |
+												 VK_COLOR_COMPONENT_B_BIT |
+												 VK_COLOR_COMPONENT_A_BIT;
+
+	return pipeline_desc;
+}
+
+// Renders offscreen frames only, meant for render farms and CI machines running a software ICD (e.g. lavapipe)
+inline static int
+_headless_main(uint32_t frames_count)
+{
+	forge::ForgeDescription forge_desc {};
+	forge_desc.headless = true;
+	forge_desc.pipeline_cache_path = "cache/pipelines.bin";
+	forge_desc.shader_cache_directory = "cache/shaders";
+	auto forge = forge::forge_new(forge_desc);
+	if (forge == nullptr)
+		return -1;
+
+	auto offscreen_frame = forge::forge_frame_new(forge);
+
+	float vertices[] = {
+		-0.5f, -0.5f, 0.0f,
+		-0.5f,  0.5f, 0.0f,
+		 0.5f, -0.5f, 0.0f,
+		 0.5f,  0.5f, 0.0f
+	};
+
+	uint16_t indices[] = {
+		0, 1, 2,
+		1, 3, 2
+	};
+
+	forge::ForgeBufferDescription vertex_buffer_desc {};
+	vertex_buffer_desc.name = "Vertex buffer";
+	vertex_buffer_desc.size = sizeof(vertices);
+	vertex_buffer_desc.memory_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	vertex_buffer_desc.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	auto vertex_buffer = forge::forge_buffer_new(forge, vertex_buffer_desc);
+	forge::forge_buffer_write(forge, vertex_buffer, vertices, sizeof(vertices));
+
+	forge::ForgeBufferDescription index_buffer_desc {};
+	index_buffer_desc.name = "Index buffer";
+	index_buffer_desc.size = sizeof(indices);
+	index_buffer_desc.memory_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	index_buffer_desc.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	auto index_buffer = forge::forge_buffer_new(forge, index_buffer_desc);
+	forge::forge_buffer_write(forge, index_buffer, indices, sizeof(indices));
+
+	auto shader_code = _shader_code_read("shader.glsl");
+	auto shader = forge::forge_shader_new(forge, _pipeline_description(), "Shader", shader_code.c_str());
+
+	float model_mat[] = {
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	};
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (uint32_t i = 0; i < frames_count; ++i)
+	{
+		forge::ForgeBindingList binding_list{};
+		forge::forge_binding_list_vertex_buffer_bind(forge, &binding_list, shader, 0u, vertex_buffer);
+		forge::forge_binding_list_index_buffer_bind(forge, &binding_list, shader, index_buffer, VK_INDEX_TYPE_UINT16);
+		forge::forge_binding_list_uniform_write(forge, &binding_list, shader, 0u, {sizeof(model_mat), model_mat});
+
+		forge::forge_frame_prepare(forge, offscreen_frame, shader, &binding_list, width, height);
+		forge::forge_frame_begin(forge, offscreen_frame);
+		forge::forge_frame_bind_resources(forge, offscreen_frame, shader, &binding_list);
+		forge::forge_frame_draw_indexed(forge, offscreen_frame, 6u, 0u, 0);
+		forge::forge_frame_end(forge, offscreen_frame);
+
+		forge::forge_flush(forge);
+	}
+
+	auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	forge::log_info("Rendered '{}' headless frames in '{}' seconds ('{}' frames per second)", frames_count, seconds, frames_count / seconds);
+
+	forge::forge_shader_destroy(forge, shader);
+	forge::forge_buffer_destroy(forge, index_buffer);
+	forge::forge_buffer_destroy(forge, vertex_buffer);
+	forge::forge_frame_destroy(forge, offscreen_frame);
+	forge::forge_destroy(forge);
+
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	bool headless = true;
+#ifdef _WIN32
+	headless = argc > 1 && strcmp(argv[1], "--headless") == 0;
+#endif
+
+	if (headless)
+	{
+		uint32_t frames_count = argc > 2 ? (uint32_t)std::stoul(argv[2]) : 1000u;
+		return _headless_main(frames_count);
+	}
+
+#ifdef _WIN32
 	if (!glfwInit())
 		return -1;
 	glfwSetErrorCallback(_glfw_error_callback);
@@ -69,7 +191,10 @@ int main()
 	glfwSetWindowSizeCallback(window, _glfw_window_size_callback);
 	auto hwnd = glfwGetWin32Window(window);
 
-	auto forge = forge::forge_new();
+	forge::ForgeDescription forge_desc {};
+	forge_desc.pipeline_cache_path = "cache/pipelines.bin";
+	forge_desc.shader_cache_directory = "cache/shaders";
+	auto forge = forge::forge_new(forge_desc);
 
 	forge::ForgeSwapchainDescription desc {};
 	desc.extent = {width, height};
@@ -110,27 +235,31 @@ int main()
 	auto vertex_buffer_full_screen = forge::forge_buffer_new(forge, vertex_buffer_desc);
 	forge::forge_buffer_write(forge, vertex_buffer_full_screen, full_screen_vertices, sizeof(full_screen_vertices));
 
-	forge::ForgePipelineDescription pipeline_desc {};
-	pipeline_desc.bindings[0].binding = 0u;
-	pipeline_desc.bindings[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-	pipeline_desc.bindings[0].stride = 3 * sizeof(float);
-	pipeline_desc.blend_desc[0].blendEnable = true;
-	pipeline_desc.blend_desc[0].colorBlendOp = VK_BLEND_OP_ADD;
-	pipeline_desc.blend_desc[0].alphaBlendOp = VK_BLEND_OP_ADD;
-	pipeline_desc.blend_desc[0].srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-	pipeline_desc.blend_desc[0].dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-	pipeline_desc.blend_desc[0].srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-	pipeline_desc.blend_desc[0].dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-	pipeline_desc.blend_desc[0].colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
-												 VK_COLOR_COMPONENT_G_BIT |
-												 VK_COLOR_COMPONENT_B_BIT |
-												 VK_COLOR_COMPONENT_A_BIT;
+	auto pipeline_desc = _pipeline_description();
 
 	auto shader_code = _shader_code_read("shader.glsl");
 	auto shader_code_compose = _shader_code_read("shader_compose.glsl");
 
-	auto shader = forge::forge_shader_new(forge, pipeline_desc, "Shader", shader_code.c_str());
-	auto shader_compose = forge::forge_shader_new(forge, pipeline_desc, "Shader compose", shader_code_compose.c_str());
+	forge::ForgeShaderSource shader_sources[] = {
+		{ "Shader", shader_code.c_str(), pipeline_desc, false },
+		{ "Shader compose", shader_code_compose.c_str(), pipeline_desc, false },
+	};
+	forge::ForgeShader* shaders[2] = {};
+	if (forge::forge_shader_new_batch(forge, shader_sources, 2u, 0u, shaders) == false)
+	{
+		// Shaders that failed are already null, the ones that compiled still need to be destroyed
+		for (auto batch_shader : shaders)
+			forge::forge_shader_destroy(forge, batch_shader);
+		forge::forge_buffer_destroy(forge, vertex_buffer_full_screen);
+		forge::forge_buffer_destroy(forge, vertex_buffer);
+		forge::forge_frame_destroy(forge, offscreen_frame);
+		forge::forge_frame_destroy(forge, swapchain_frame);
+		forge::forge_destroy(forge);
+		return -1;
+	}
+
+	auto shader = shaders[0];
+	auto shader_compose = shaders[1];
 
 	float model_mat[] = {
 		1.0f, 0.0f, 0.0f, 0.0f,
@@ -159,7 +288,7 @@ int main()
 
 		forge::forge_frame_prepare(forge, swapchain_frame, shader_compose, &swapchain_binding_list, width, height);
 		forge::forge_frame_begin(forge, swapchain_frame);
-		forge::forge_frame_bind_resources(forge, swapchain_frame, shader_compose, &offscreen_binding_list);
+		forge::forge_frame_bind_resources(forge, swapchain_frame, shader_compose, &swapchain_binding_list);
 		forge::forge_frame_draw(forge, swapchain_frame, 6u);
 		forge::forge_frame_end(forge, swapchain_frame);
 
@@ -177,4 +306,5 @@ int main()
 	forge::forge_destroy(forge);
 
 	return 0;
+#endif
 }
\ No newline at end of file
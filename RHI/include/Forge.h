@@ -22,16 +22,50 @@ namespace forge
 	struct ForgeDeletionQueue;
 	struct ForgeDescriptorSetManager;
 	struct ForgeCommandBufferManager;
+	struct ForgeMemoryAllocator;
+	struct ForgeStaging;
+	struct ForgePipelineCache;
+	struct ForgeShaderCache;
+	struct ForgeBindlessTable;
+	struct ForgeSamplerCache;
+	struct ForgeWorkerPool;
 
 	static constexpr uint32_t FORGE_MAX_OFF_SCREEN_FRAMES = 16u;
 
+	struct ForgeDescription
+	{
+		// No surface/swapchain extensions and no presentation support requirement, only offscreen frames are submitted
+		bool headless = false;
+
+		// Where the pipeline cache is loaded from and written back to, an empty path keeps it in memory only
+		std::string pipeline_cache_path;
+
+		// Directory compiled SPIR-V is cached in, an empty path keeps it in memory only
+		std::string shader_cache_directory;
+
+		// Enables descriptor indexing and writes every sampled image into a bindless table, ignored if unsupported
+		bool bindless = false;
+
+		// Per draw sets (FORGE_SHADER_SET_DRAW) are written straight into the command buffer with VK_KHR_push_descriptor
+		// instead of going through the descriptor set manager, ignored if unsupported
+		bool push_descriptors = false;
+
+		// Graphics pipelines are compiled by this many background threads, draws recorded while their pipeline is still
+		// compiling are skipped. Zero compiles them on the recording thread instead.
+		uint32_t pipeline_worker_threads = 0u;
+	};
+
 	struct Forge
 	{
+		ForgeDescription description;
+
 		VkInstance instance;
 
 		VkPhysicalDevice physical_device;
 		VkPhysicalDeviceMemoryProperties physical_device_memory_properties;
 		VkPhysicalDeviceLimits physical_device_limits;
+		VkPhysicalDeviceFeatures physical_device_features; // Enabled features, optional ones are only set if supported
+		VkPhysicalDeviceVulkan12Features physical_device_features_12;
 		std::string physical_device_name;
 		uint64_t physical_memory;
 		uint32_t queue_family_index;
@@ -39,13 +73,18 @@ namespace forge
 		VkDevice device;
 		VkQueue queue;
 
-		ForgeBuffer* staging_buffer;
-		VkCommandBuffer staging_command_buffer;
+		ForgeStaging* staging;
 
+		ForgeMemoryAllocator* memory_allocator;
 		ForgeDynamicMemory* uniform_memory;
 		ForgeDeletionQueue* deletion_queue;
 		ForgeDescriptorSetManager* descriptor_set_manager;
 		ForgeCommandBufferManager* command_buffer_manager;
+		ForgePipelineCache* pipeline_cache;
+		ForgeShaderCache* shader_cache;
+		ForgeBindlessTable* bindless_table; // Only created when bindless is requested and supported
+		ForgeSamplerCache* sampler_cache;
+		ForgeWorkerPool* worker_pool; // Only created with pipeline worker threads
 
 		VkDebugUtilsMessengerEXT debug_messenger;
 		PFN_vkCreateDebugUtilsMessengerEXT pfn_vkCreateDebugUtilsMessengerEXT;
@@ -53,6 +92,7 @@ namespace forge
 		PFN_vkSetDebugUtilsObjectNameEXT pfn_vkSetDebugUtilsObjectNameEXT;
 		PFN_vkCmdBeginDebugUtilsLabelEXT pfn_vkCmdBeginDebugUtilsLabelEXT;
 		PFN_vkCmdEndDebugUtilsLabelEXT pfn_vkCmdEndDebugUtilsLabelEXT;
+		PFN_vkCmdPushDescriptorSetWithTemplateKHR pfn_vkCmdPushDescriptorSetWithTemplateKHR; // Only loaded with push descriptors
 
 		ForgeFrame* swapchain_frame;
 		ForgeFrame* offscreen_frames[FORGE_MAX_OFF_SCREEN_FRAMES];
@@ -66,6 +106,9 @@ namespace forge
 	Forge*
 	forge_new();
 
+	Forge*
+	forge_new(ForgeDescription description);
+
 	void
 	forge_destroy(Forge* forge);
 
@@ -9,16 +9,21 @@ namespace forge
 	struct Forge;
 	struct ForgeBuffer;
 	struct ForgeImage;
+	struct ForgeSampler;
 
 	static constexpr uint32_t FORGE_MAX_VERTEX_BUFFER_BINDINGS = 16u;
 	static constexpr uint32_t FORGE_MAX_IMAGE_BINDINGS = 16u;
+	static constexpr uint32_t FORGE_MAX_STORAGE_BUFFER_BINDINGS = FORGE_SHADER_MAX_STORAGE_BUFFERS;
 
 	struct ForgeBindingList
 	{
 		std::pair<uint32_t, void*> uniforms[FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS];
 		ForgeBuffer* vertex_buffers[FORGE_MAX_VERTEX_BUFFER_BINDINGS];
 		ForgeBuffer* index_buffer;
+		VkIndexType index_type = VK_INDEX_TYPE_UINT32;
 		ForgeImage* images[FORGE_MAX_IMAGE_BINDINGS];
+		ForgeSampler* samplers[FORGE_MAX_IMAGE_BINDINGS]; // Override the bound image's own sampler when set
+		ForgeBuffer* storage_buffers[FORGE_MAX_STORAGE_BUFFER_BINDINGS];
 	};
 
 	bool
@@ -28,8 +33,16 @@ namespace forge
 	forge_binding_list_vertex_buffer_bind(Forge* forge, ForgeBindingList* list, ForgeShader* shader, uint32_t binding, ForgeBuffer* buffer);
 
 	bool
-	forge_binding_list_index_buffer_bind(Forge* forge, ForgeBindingList* list, ForgeShader* shader, ForgeBuffer* buffer);
+	forge_binding_list_index_buffer_bind(Forge* forge, ForgeBindingList* list, ForgeShader* shader, ForgeBuffer* buffer, VkIndexType index_type = VK_INDEX_TYPE_UINT32);
 
 	bool
 	forge_binding_list_image_bind(Forge* forge, ForgeBindingList* list, ForgeShader* shader, uint32_t binding, ForgeImage* image);
+
+	// Samples the image at 'binding' with 'sampler' instead of the sampler it was created with, e.g. a compare sampler
+	// for a shadow map. The binding list doesn't hold a reference, the sampler must outlive its use.
+	bool
+	forge_binding_list_sampler_bind(Forge* forge, ForgeBindingList* list, ForgeShader* shader, uint32_t binding, ForgeSampler* sampler);
+
+	bool
+	forge_binding_list_storage_buffer_bind(Forge* forge, ForgeBindingList* list, ForgeShader* shader, uint32_t binding, ForgeBuffer* buffer);
 };
\ No newline at end of file
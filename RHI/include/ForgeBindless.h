@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <mutex>
+
+namespace forge
+{
+	struct Forge;
+	struct ForgeImage;
+
+	static constexpr uint32_t FORGE_BINDLESS_SET = 3u; // Highest set every device can bind, maxBoundDescriptorSets is at least 4
+	static constexpr uint32_t FORGE_BINDLESS_MAX_IMAGES = 16384u;
+	static constexpr uint32_t FORGE_BINDLESS_INVALID_INDEX = UINT32_MAX;
+
+	// A single update-after-bind array of combined image samplers every sampled 2D image is written into on creation.
+	// Shaders index it with the image's bindless_index through
+	//     layout(set = 3, binding = 0) uniform sampler2D forge_images[];
+	// (indices that vary within a draw need GL_EXT_nonuniform_qualifier's nonuniformEXT) so switching materials doesn't allocate, update or bind descriptor sets. Images must be in
+	// VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL when sampled through the table.
+	struct ForgeBindlessTable
+	{
+		VkDescriptorSetLayout layout;
+		VkDescriptorPool pool;
+		VkDescriptorSet set;
+		uint32_t capacity;
+		uint32_t next_index;
+		std::vector<uint32_t> free_indices;
+		std::mutex mutex;
+	};
+
+	ForgeBindlessTable*
+	forge_bindless_table_new(Forge* forge);
+
+	uint32_t
+	forge_bindless_table_image_add(Forge* forge, ForgeBindlessTable* table, ForgeImage* image);
+
+	// The index is handed out again once the GPU is done with the frame that is currently being recorded
+	void
+	forge_bindless_table_image_remove(Forge* forge, ForgeBindlessTable* table, uint32_t index);
+
+	void
+	forge_bindless_table_destroy(Forge* forge, ForgeBindlessTable* table);
+};
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "ForgeMemoryAllocator.h"
+
 #include <vulkan/vulkan.h>
 
 namespace forge
@@ -17,9 +19,11 @@ namespace forge
 	struct ForgeBuffer
 	{
 		VkBuffer handle;
-		VkDeviceMemory memory;
+		ForgeMemoryAllocation memory;
 		void* mapped_ptr;
-		uint32_t cursor;
+		uint64_t upload_signal; // Staging timeline value signaled once the last write lands
+		VkPipelineStageFlags stage; // Stages and accesses of the last recorded GPU use, reads accumulate until a write
+		VkAccessFlags access;
 		ForgeBufferDescription description;
 	};
 
@@ -29,6 +33,13 @@ namespace forge
 	void
 	forge_buffer_write(Forge* forge, ForgeBuffer* buffer, void* data, uint32_t size);
 
+	// Records a barrier against the last tracked use when either side writes, consecutive reads don't wait on each other.
+	// The tracked use follows recording order and isn't synchronized, every barrier on a buffer has to be recorded from
+	// a single thread into command buffers submitted in that same order (e.g. the primary frames and compute work of
+	// the thread calling forge_flush), never from secondary frames recorded on other threads.
+	void
+	forge_buffer_barrier(Forge* forge, VkCommandBuffer command_buffer, VkPipelineStageFlags stage, VkAccessFlags access, ForgeBuffer* buffer);
+
 	void
 	forge_buffer_destroy(Forge* forge, ForgeBuffer* buffer);
 };
\ No newline at end of file
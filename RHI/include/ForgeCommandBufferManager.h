@@ -3,22 +3,39 @@
 #include <vulkan/vulkan.h>
 
 #include <vector>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace forge
 {
 	struct Forge;
 
-	struct ForgeCommandBuffer
+	struct ForgeCommandPool
 	{
-		VkCommandBuffer handle;
-		VkCommandPool pool;
+		VkCommandPool handle;
+		std::vector<VkCommandBuffer> command_buffers;
+		std::vector<VkCommandBuffer> secondary_command_buffers;
+		uint32_t used; // Command buffers handed out since the last reset
+		uint32_t secondary_used;
 		uint64_t release_signal;
 	};
 
+	// Pools owned by a single recording thread, only that thread ever touches them so recording doesn't need to lock
+	struct ForgeCommandPoolSet
+	{
+		std::vector<ForgeCommandPool> pools;
+		uint32_t current;
+	};
+
+	// Every thread that acquires a command buffer gets its own set of pools, a pool hands out command buffers for a single
+	// frame and is reset as a whole once the timeline passes its release signal.
+	// Recording can happen on any thread as long as forge_flush isn't called while other threads are still recording.
+	// Sets live until forge_destroy, threads that stop recording before that have to release theirs.
 	struct ForgeCommandBufferManager
 	{
-		VkCommandPool pool;
-		std::vector<ForgeCommandBuffer> allocated_cb;
+		std::mutex mutex; // Guards the thread lookup only
+		std::unordered_map<std::thread::id, ForgeCommandPoolSet*> pool_sets;
 	};
 
 	ForgeCommandBufferManager*
@@ -30,4 +47,13 @@ namespace forge
 	VkCommandBuffer
 	forge_command_buffer_acquire(Forge* forge, ForgeCommandBufferManager* manager, bool begin);
 
+	// Returns an already begun secondary command buffer that continues subpass 0 of the given pass
+	VkCommandBuffer
+	forge_command_buffer_acquire_secondary(Forge* forge, ForgeCommandBufferManager* manager, VkRenderPass pass, VkFramebuffer framebuffer);
+
+	// Called by a recording thread before it exits, its pools are destroyed once the GPU is done with what they recorded.
+	// Command buffers the thread recorded stay valid until then, a later acquire on the same thread starts a new set.
+	void
+	forge_command_buffer_manager_thread_release(Forge* forge, ForgeCommandBufferManager* manager);
+
 }
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+namespace forge
+{
+	struct Forge;
+	struct ForgeFrame;
+	struct ForgeShader;
+	struct ForgeBuffer;
+	struct ForgeBindingList;
+
+	// Dispatches are recorded into the frame's command buffer outside of its render pass, i.e. between
+	// forge_frame_prepare and forge_frame_begin. Storage images are moved to VK_IMAGE_LAYOUT_GENERAL and sampled ones to
+	// VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, storage buffers get barriers against their last tracked use. Writes are
+	// made visible to later dispatches and to the frame's pass.
+	bool
+	forge_compute_dispatch(Forge* forge, ForgeFrame* frame, ForgeShader* shader, ForgeBindingList* binding_list, uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z);
+
+	// Group counts are read as a VkDispatchIndirectCommand from a buffer created with VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
+	bool
+	forge_compute_dispatch_indirect(Forge* forge, ForgeFrame* frame, ForgeShader* shader, ForgeBindingList* binding_list, ForgeBuffer* buffer, uint64_t offset);
+};
\ No newline at end of file
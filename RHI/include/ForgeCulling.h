@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+namespace forge
+{
+	struct Forge;
+	struct ForgeBuffer;
+	struct ForgeImage;
+	struct ForgeFrame;
+	struct ForgeShader;
+
+	static constexpr uint32_t FORGE_CULLING_GROUP_SIZE = 64u; // Must match local_size_x in the culling shader
+
+	// Per object bounds as laid out in the objects storage buffer (std430)
+	struct ForgeCullingObject
+	{
+		float center[3];
+		float radius;
+		uint32_t index_count;
+		uint32_t first_index;
+		int32_t vertex_offset;
+		uint32_t instance_id; // Written as firstInstance so the vertex shader can fetch per object data with gl_InstanceIndex
+	};
+
+	struct ForgeCullingDescription
+	{
+		ForgeBuffer* objects;	// ForgeCullingObject[objects_count], needs VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+		uint32_t objects_count;
+		ForgeBuffer* draws;		// VkDrawIndexedIndirectCommand[objects_count], needs storage and indirect usage
+		ForgeBuffer* count;		// A single uint32_t, needs storage, indirect and transfer dst usage
+		float view_projection[16]; // Column major, depth in [0, 1]
+		ForgeImage* hiz;		// Optional max depth pyramid (e.g. of the previous frame), sampled with its own sampler
+	};
+
+	// Culls objects against the frustum and optionally a Hi-Z pyramid on the GPU and writes the survivors as compacted
+	// indexed indirect draws plus their count, ready for forge_frame_draw_indexed_indirect_count. Requires
+	// drawIndirectFirstInstance, forge_culling_new fails without it.
+	// The culling shader is an ordinary compute shader dispatched through forge_compute_dispatch.
+	struct ForgeCulling
+	{
+		ForgeShader* shader;
+		ForgeImage* hiz_fallback; // Keeps the binding valid when no pyramid is provided
+	};
+
+	ForgeCulling*
+	forge_culling_new(Forge* forge);
+
+	// Records the culling dispatch into the frame's command buffer, must happen between forge_frame_prepare and forge_frame_begin
+	bool
+	forge_culling_dispatch(Forge* forge, ForgeCulling* culling, ForgeFrame* frame, ForgeCullingDescription description);
+
+	void
+	forge_culling_destroy(Forge* forge, ForgeCulling* culling);
+};
\ No newline at end of file
@@ -6,6 +6,8 @@
 #include <vulkan/vulkan.h>
 
 #include <vector>
+#include <mutex>
+#include <functional>
 
 namespace forge
 {
@@ -16,8 +18,10 @@ namespace forge
 			uint64_t signal;
 			VkObjectType type;
 			void* handle;
+			std::function<void()> callback;
 		};
 
+		std::mutex mutex;
 		std::vector<Entry> entries;
 	};
 
@@ -31,9 +35,15 @@ namespace forge
 		entry.signal = forge->timeline_next_signal;
 		entry.handle = handle;
 		entry.type = _vk_object_type<T>();
+
+		std::lock_guard<std::mutex> lock(queue->mutex);
 		queue->entries.push_back(std::move(entry));
 	};
 
+	// Defers releasing resources that aren't vulkan objects (e.g. sub-allocated memory ranges) until the GPU is done with them
+	void
+	forge_deletion_queue_push_callback(Forge* forge, ForgeDeletionQueue* queue, std::function<void()> callback);
+
 	void
 	forge_deletion_queue_flush(Forge* forge, ForgeDeletionQueue* queue, bool immediate);
 
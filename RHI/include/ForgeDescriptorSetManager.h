@@ -3,6 +3,7 @@
 #include <vulkan/vulkan.h>
 
 #include <vector>
+#include <mutex>
 #include <unordered_map>
 
 namespace forge
@@ -12,10 +13,12 @@ namespace forge
 	struct ForgeShader;
 
 	static constexpr uint32_t FORGE_DESCRIPTOR_SET_MANAGER_SET_MAX_AGE = 10u; // frames
-	static constexpr uint32_t FORGE_DESCRIPTOR_SET_MANAGER_MAX_DESCRIPTOR_SETS = 256u;
-	static constexpr uint32_t FORGE_DESCRIPTOR_SET_MANAGER_MAX_SAMPLED_IMAGES = FORGE_DESCRIPTOR_SET_MANAGER_MAX_DESCRIPTOR_SETS * 64u;
-	static constexpr uint32_t FORGE_DESCRIPTOR_SET_MANAGER_MAX_STORAGE_IMAGES = FORGE_DESCRIPTOR_SET_MANAGER_MAX_DESCRIPTOR_SETS * 64u;
-	static constexpr uint32_t FORGE_DESCRIPTOR_SET_MANAGER_MAX_DYNAMIC_UNIFORM_BUFFERS = FORGE_DESCRIPTOR_SET_MANAGER_MAX_DESCRIPTOR_SETS * 16u;
+	static constexpr uint32_t FORGE_DESCRIPTOR_SET_MANAGER_POOL_MAX_DESCRIPTOR_SETS = 256u;
+	static constexpr uint32_t FORGE_DESCRIPTOR_SET_MANAGER_POOL_MAX_SAMPLED_IMAGES = FORGE_DESCRIPTOR_SET_MANAGER_POOL_MAX_DESCRIPTOR_SETS * 64u;
+	static constexpr uint32_t FORGE_DESCRIPTOR_SET_MANAGER_POOL_MAX_STORAGE_IMAGES = FORGE_DESCRIPTOR_SET_MANAGER_POOL_MAX_DESCRIPTOR_SETS * 64u;
+	static constexpr uint32_t FORGE_DESCRIPTOR_SET_MANAGER_POOL_MAX_DYNAMIC_UNIFORM_BUFFERS = FORGE_DESCRIPTOR_SET_MANAGER_POOL_MAX_DESCRIPTOR_SETS * 16u;
+	static constexpr uint32_t FORGE_DESCRIPTOR_SET_MANAGER_POOL_MAX_STORAGE_BUFFERS = FORGE_DESCRIPTOR_SET_MANAGER_POOL_MAX_DESCRIPTOR_SETS * 8u;
+	static constexpr uint32_t FORGE_DESCRIPTOR_SET_INVALID_INDEX = UINT32_MAX;
 
 	struct ForgeDescriptorSet
 	{
@@ -23,19 +26,39 @@ namespace forge
 		VkDescriptorSetLayout layout;
 		uint64_t active_bindings_hash;
 		uint64_t release_signal;
+		uint32_t prev; // Neighbours in the per layout list which is kept ordered by release signal
+		uint32_t next;
+	};
+
+	struct ForgeDescriptorSetList
+	{
+		uint32_t head = FORGE_DESCRIPTOR_SET_INVALID_INDEX; // Least recently used
+		uint32_t tail = FORGE_DESCRIPTOR_SET_INVALID_INDEX; // Most recently used
 	};
 
 	struct ForgeDescriptorSetManager
 	{
-		VkDescriptorPool pool;
+		std::vector<VkDescriptorPool> pools;
 		std::vector<ForgeDescriptorSet> allocated_sets;
+		std::unordered_map<uint64_t, uint32_t> sets_lookup; // hash(layout, bindings) -> allocated set index
+		std::unordered_map<VkDescriptorSetLayout, ForgeDescriptorSetList> layout_sets;
+		std::mutex mutex;
 	};
 
 	ForgeDescriptorSetManager*
 	forge_descriptor_set_manager_new(Forge* forge);
 
+	// Hashes the descriptor payload the binding list writes to the shader's set, uniforms only contribute their ranges
+	// since their offsets are dynamic
+	uint64_t
+	forge_descriptor_set_bindings_hash(Forge* forge, ForgeShader* shader, uint32_t set_index, ForgeBindingList* binding_list);
+
 	VkDescriptorSet
-	forge_descriptor_set_acquire(Forge* forge, ForgeDescriptorSetManager* manager, ForgeShader* shader, ForgeBindingList* binding_list);
+	forge_descriptor_set_acquire(Forge* forge, ForgeDescriptorSetManager* manager, ForgeShader* shader, uint32_t set_index, ForgeBindingList* binding_list);
+
+	// Writes the shader's pushed set straight into the command buffer, uniforms are written to dynamic memory on every push
+	bool
+	forge_descriptor_set_push(Forge* forge, VkCommandBuffer command_buffer, ForgeShader* shader, uint32_t set_index, ForgeBindingList* binding_list);
 
 	void
 	forge_descriptor_set_manager_destroy(Forge* forge, ForgeDescriptorSetManager* manager);
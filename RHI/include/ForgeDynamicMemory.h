@@ -2,6 +2,8 @@
 
 #include <vulkan/vulkan.h>
 
+#include <mutex>
+
 namespace forge
 {
 	struct Forge;
@@ -16,6 +18,7 @@ namespace forge
 		uint32_t cursor[FORGE_DYNAMIC_MEMORY_MAX_SEGMENTTS];
 		uint32_t release_signal[FORGE_DYNAMIC_MEMORY_MAX_SEGMENTTS];
 		uint32_t current;
+		std::mutex mutex;
 	};
 
 	ForgeDynamicMemory*
@@ -18,6 +18,7 @@ namespace forge
 	static constexpr uint32_t FORGE_FRAME_MAX_UNIFORM_MEMORY = 16 << 20;
 	static constexpr uint32_t FORGE_FRAME_MAX_VERTEX_BUFFERS = 16u;
 	static constexpr uint32_t FORGE_FRAME_MAX_IMAGES = 16u;
+	static constexpr uint32_t FORGE_FRAME_MAX_SECONDARY_FRAMES = 64u;
 
 	struct ForgeFrameResourcesList
 	{
@@ -25,16 +26,33 @@ namespace forge
 		ForgeBuffer* vertex_buffers[FORGE_FRAME_MAX_VERTEX_BUFFERS];
 		ForgeBuffer* index_buffer;
 		ForgeImage* images[FORGE_FRAME_MAX_IMAGES];
+		ForgeBuffer* storage_buffers[FORGE_SHADER_MAX_STORAGE_BUFFERS];
 		ForgeShader* shader;
 	};
 
+	// What's currently bound at a set index, a set is only rewritten and rebound when its bindings or uniforms change
+	struct ForgeFrameSetState
+	{
+		bool bound;
+		VkDescriptorSet handle; // Null for pushed sets
+		uint64_t bindings_hash;
+		uint64_t uniforms_hash; // Hash of the uniforms' contents
+		uint32_t uniform_offsets[FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS];
+		uint32_t uniform_offsets_count;
+	};
+
 	struct ForgeFrame
 	{
 		ForgeSwapchain* swapchain;
 		ForgeRenderPass* pass;
 		ForgeFrameResourcesList resources_list;
 		VkCommandBuffer command_buffer;
-		VkDescriptorSet set;
+		ForgeFrameSetState bound_sets[FORGE_SHADER_MAX_SETS];
+		VkPipelineLayout bound_layout;
+		VkPipeline bound_pipeline;
+		ForgeShader* bound_shader;
+		bool pipeline_missing; // The last bound shader's pipeline is still compiling or failed, draws are skipped
+		ForgeFrame* parent; // Only set for secondary frames
 	};
 
 	ForgeFrame*
@@ -43,15 +61,49 @@ namespace forge
 	ForgeFrame*
 	forge_frame_new(Forge* forge, ForgeSwapchainDescription swapchain_desc);
 
+	// Acquires the frame's command buffer, compute work that feeds the pass is recorded between prepare and begin
 	void
 	forge_frame_prepare(Forge* forge, ForgeFrame* frame, ForgeShader* shader, ForgeBindingList* binding_list, uint32_t width, uint32_t height);
 
+	// Beginning with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS means draws are recorded into secondary frames and
+	// executed with forge_frame_execute
 	bool
-	forge_frame_begin(Forge* forge, ForgeFrame* frame);
+	forge_frame_begin(Forge* forge, ForgeFrame* frame, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
 
 	void
 	forge_frame_draw(Forge* forge, ForgeFrame* frame, uint32_t vertex_count);
 
+	// Bindings described with VK_VERTEX_INPUT_RATE_INSTANCE in the pipeline description advance once per instance
+	void
+	forge_frame_draw_instanced(Forge* forge, ForgeFrame* frame, uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance);
+
+	// Reads indices from the binding list's index buffer with the index type it was bound with
+	void
+	forge_frame_draw_indexed(Forge* forge, ForgeFrame* frame, uint32_t index_count, uint32_t first_index, int32_t vertex_offset);
+
+	void
+	forge_frame_draw_indexed_instanced(Forge* forge, ForgeFrame* frame, uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance);
+
+	// Draw arguments are read from a buffer created with VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, without multiDrawIndirect
+	// support the draws are issued one command at a time
+	void
+	forge_frame_draw_indirect(Forge* forge, ForgeFrame* frame, ForgeBuffer* buffer, uint64_t offset, uint32_t draw_count, uint32_t stride = sizeof(VkDrawIndirectCommand));
+
+	void
+	forge_frame_draw_indexed_indirect(Forge* forge, ForgeFrame* frame, ForgeBuffer* buffer, uint64_t offset, uint32_t draw_count, uint32_t stride = sizeof(VkDrawIndexedIndirectCommand));
+
+	// The draw count is read from 'count_buffer' and clamped to 'max_draw_count', requires drawIndirectCount support
+	void
+	forge_frame_draw_indirect_count(Forge* forge, ForgeFrame* frame, ForgeBuffer* buffer, uint64_t offset, ForgeBuffer* count_buffer, uint64_t count_offset, uint32_t max_draw_count, uint32_t stride = sizeof(VkDrawIndirectCommand));
+
+	void
+	forge_frame_draw_indexed_indirect_count(Forge* forge, ForgeFrame* frame, ForgeBuffer* buffer, uint64_t offset, ForgeBuffer* count_buffer, uint64_t count_offset, uint32_t max_draw_count, uint32_t stride = sizeof(VkDrawIndexedIndirectCommand));
+
+	// Writes the shader's push constant block straight into the command buffer, 'size' bytes from the start of the block.
+	// Works for compute shaders too as long as it's called before their dispatch.
+	void
+	forge_frame_push_constants(Forge* forge, ForgeFrame* frame, ForgeShader* shader, const void* data, uint32_t size);
+
 	void
 	forge_frame_end(Forge* forge, ForgeFrame* frame);
 
@@ -61,9 +113,27 @@ namespace forge
 	ForgeImage*
 	forge_frame_depth_attachment(Forge* forge, ForgeFrame* frame);
 
+	// Only the sets whose bindings or uniform contents changed since the last call are updated and rebound, switching
+	// to a shader with another pipeline layout rebinds everything
 	void
 	forge_frame_bind_resources(Forge* forge, ForgeFrame* frame, ForgeShader* shader, ForgeBindingList* binding_list);
 
+	// Secondary frames record into secondary command buffers that continue the parent's pass, they're never submitted on
+	// their own. Each worker thread records into its own secondary frame.
+	ForgeFrame*
+	forge_frame_secondary_new(Forge* forge, ForgeFrame* parent);
+
+	// The parent must be prepared and begun with secondary contents, images and storage buffers used by the secondary
+	// frame must be bound to the parent's prepare since layout transitions and barriers aren't possible inside the pass
+	bool
+	forge_frame_secondary_begin(Forge* forge, ForgeFrame* secondary, ForgeShader* shader, ForgeBindingList* binding_list);
+
+	void
+	forge_frame_secondary_end(Forge* forge, ForgeFrame* secondary);
+
+	void
+	forge_frame_execute(Forge* forge, ForgeFrame* frame, ForgeFrame** secondaries, uint32_t secondaries_count);
+
 	void
 	forge_frame_destroy(Forge* forge, ForgeFrame* frame);
 };
\ No newline at end of file
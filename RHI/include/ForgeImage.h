@@ -1,5 +1,7 @@
 #pragma once
 
+#include "ForgeMemoryAllocator.h"
+
 #include <vulkan/vulkan.h>
 
 #include <string>
@@ -7,6 +9,7 @@
 namespace forge
 {
 	struct Forge;
+	struct ForgeSampler;
 
 	struct ForgeImageDescription
 	{
@@ -23,19 +26,22 @@ namespace forge
 		VkSamplerAddressMode address_mode_u = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
 		VkSamplerAddressMode address_mode_v = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
 		VkSamplerAddressMode address_mode_w = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		float max_anisotropy = 1.0f;
 		bool mipmaps = false;
 	};
 
 	struct ForgeImage
 	{
 		VkImage handle;
-		VkDeviceMemory memory;
+		ForgeMemoryAllocation memory;
 		VkImageView shader_view;
 		VkImageView render_target_view;
 		VkImageViewType view_type;
-		VkSampler sampler;
+		ForgeSampler* sampler; // Shared through the sampler cache, null for storage images
 		VkImageLayout layout;
 		VkImageAspectFlags aspect;
+		uint64_t upload_signal; // Staging timeline value signaled once the last write lands
+		uint32_t bindless_index; // Slot in the bindless table, FORGE_BINDLESS_INVALID_INDEX if it isn't registered
 		ForgeImageDescription description;
 	};
 
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <mutex>
+
+namespace forge
+{
+	struct Forge;
+
+	static constexpr VkDeviceSize FORGE_MEMORY_ALLOCATOR_BLOCK_SIZE = 64ull << 20;
+
+	enum FORGE_MEMORY_RESOURCE
+	{
+		FORGE_MEMORY_RESOURCE_LINEAR,	// Buffers
+		FORGE_MEMORY_RESOURCE_OPTIMAL,	// Optimally tiled images
+		FORGE_MEMORY_RESOURCE_COUNT,
+	};
+
+	struct ForgeMemoryRange
+	{
+		VkDeviceSize offset;
+		VkDeviceSize size;
+	};
+
+	struct ForgeMemoryBlock
+	{
+		VkDeviceMemory memory;
+		VkDeviceSize size;
+		VkDeviceSize used;
+		void* mapped_ptr;
+		std::vector<ForgeMemoryRange> free_ranges; // Sorted by offset
+	};
+
+	struct ForgeMemoryPool
+	{
+		uint32_t memory_type_index;
+		VkMemoryPropertyFlags memory_properties;
+		std::vector<ForgeMemoryBlock*> blocks;
+	};
+
+	struct ForgeMemoryAllocation
+	{
+		VkDeviceMemory memory;
+		VkDeviceSize offset;
+		VkDeviceSize size;
+		void* mapped_ptr;
+		ForgeMemoryPool* pool;
+		ForgeMemoryBlock* block;
+	};
+
+	// Hands out sub-ranges of large VkDeviceMemory blocks, one pool per memory type.
+	// Buffers and optimal images live in separate pools when the device reports a bufferImageGranularity larger than 1
+	// so a linear and a non-linear resource can never share a granularity page.
+	struct ForgeMemoryAllocator
+	{
+		ForgeMemoryPool pools[VK_MAX_MEMORY_TYPES][FORGE_MEMORY_RESOURCE_COUNT];
+		VkDeviceSize buffer_image_granularity;
+		VkDeviceSize non_coherent_atom_size;
+		uint32_t blocks_count;
+		uint32_t allocations_count;
+		std::mutex mutex;
+	};
+
+	ForgeMemoryAllocator*
+	forge_memory_allocator_new(Forge* forge);
+
+	bool
+	forge_memory_allocator_allocate(Forge* forge, ForgeMemoryAllocator* allocator, VkMemoryRequirements requirements, VkMemoryPropertyFlags properties, FORGE_MEMORY_RESOURCE resource, ForgeMemoryAllocation* allocation);
+
+	// The range is returned to its block once the GPU is done with the frame that is currently being recorded
+	void
+	forge_memory_allocator_free(Forge* forge, ForgeMemoryAllocator* allocator, ForgeMemoryAllocation allocation);
+
+	void
+	forge_memory_allocator_destroy(Forge* forge, ForgeMemoryAllocator* allocator);
+};
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+
+namespace forge
+{
+	struct Forge;
+
+	static constexpr uint32_t FORGE_PIPELINE_CACHE_MAGIC = 0x48435046u; // "FPCH"
+	static constexpr uint32_t FORGE_PIPELINE_CACHE_VERSION = 1u;
+
+	// Prepended to the driver blob on disk, a blob is only handed back to the driver if every field matches the current device
+	struct ForgePipelineCacheHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t vendor_id;
+		uint32_t device_id;
+		uint32_t driver_version;
+		uint8_t uuid[VK_UUID_SIZE];
+		uint64_t data_size;
+		uint64_t data_hash;
+	};
+
+	struct ForgePipelineCache
+	{
+		VkPipelineCache handle;
+		std::string path;
+		ForgePipelineCacheHeader header;
+		size_t saved_size;
+	};
+
+	// An empty path keeps the cache in memory only
+	ForgePipelineCache*
+	forge_pipeline_cache_new(Forge* forge, const std::string& path);
+
+	// Atomically writes the cache back to its path, does nothing if nothing was added since the last flush
+	bool
+	forge_pipeline_cache_flush(Forge* forge, ForgePipelineCache* cache);
+
+	void
+	forge_pipeline_cache_destroy(Forge* forge, ForgePipelineCache* cache);
+};
\ No newline at end of file
@@ -33,6 +33,7 @@ namespace forge
 	{
 		VkRenderPass handle;
 		VkFramebuffer framebuffer;
+		uint64_t compatibility_hash; // Equal for render passes a pipeline can be used with interchangeably
 		uint32_t width;
 		uint32_t height;
 		ForgeRenderPassDescription description;
@@ -41,8 +42,17 @@ namespace forge
 	ForgeRenderPass*
 	forge_render_pass_new(Forge* forge, ForgeRenderPassDescription description);
 
+	// Creates a bare render pass compatible with 'render_pass' and owned by the caller, for work such as background
+	// pipeline compilation that must not depend on the pass staying alive
+	VkRenderPass
+	forge_render_pass_compatible_new(Forge* forge, ForgeRenderPass* render_pass);
+
+	// With VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS the draws come from secondary command buffers, which set their own viewport
+	void
+	forge_render_pass_begin(Forge* forge, VkCommandBuffer command_buffer, ForgeRenderPass* render_pass, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+
 	void
-	forge_render_pass_begin(Forge* forge, VkCommandBuffer command_buffer, ForgeRenderPass* render_pass);
+	forge_render_pass_viewport_set(Forge* forge, VkCommandBuffer command_buffer, ForgeRenderPass* render_pass);
 
 	void
 	forge_render_pass_end(Forge* forge, VkCommandBuffer command_buffer, ForgeRenderPass* render_pass);
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <unordered_map>
+#include <mutex>
+
+namespace forge
+{
+	struct Forge;
+
+	struct ForgeSamplerDescription
+	{
+		VkFilter mag_filter = VK_FILTER_LINEAR;
+		VkFilter min_filter = VK_FILTER_LINEAR;
+		VkSamplerMipmapMode mipmap_mode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		VkSamplerAddressMode address_mode_u = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		VkSamplerAddressMode address_mode_v = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		VkSamplerAddressMode address_mode_w = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		VkBorderColor border_color = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+		float max_anisotropy = 1.0f; // Anything above 1 enables anisotropic filtering if the device supports it, clamped to its limit
+		bool compare = false; // Depth comparison for shadow maps, sampled through sampler2DShadow
+		VkCompareOp compare_op = VK_COMPARE_OP_LESS_OR_EQUAL;
+	};
+
+	struct ForgeSampler
+	{
+		VkSampler handle;
+		uint64_t hash;
+		uint32_t references;
+		ForgeSamplerDescription description;
+	};
+
+	// Samplers are shared by every image and binding list that asks for the same description, drivers cap the number of
+	// live samplers (maxSamplerAllocationCount can be as low as 4000) way below the number of images an app can have
+	struct ForgeSamplerCache
+	{
+		std::unordered_multimap<uint64_t, ForgeSampler*> samplers; // Colliding hashes are told apart by their description
+		std::mutex mutex;
+	};
+
+	ForgeSamplerCache*
+	forge_sampler_cache_new(Forge* forge);
+
+	// Returns the cached sampler matching the description, every acquire must be paired with a release
+	ForgeSampler*
+	forge_sampler_acquire(Forge* forge, ForgeSamplerCache* cache, const ForgeSamplerDescription& description);
+
+	// The last release destroys the sampler once the GPU is done with the frame that is currently being recorded
+	void
+	forge_sampler_release(Forge* forge, ForgeSamplerCache* cache, ForgeSampler* sampler);
+
+	void
+	forge_sampler_cache_destroy(Forge* forge, ForgeSamplerCache* cache);
+};
\ No newline at end of file
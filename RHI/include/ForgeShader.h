@@ -1,30 +1,49 @@
 #pragma once
 
 #include "ForgeRenderPass.h"
+#include "ForgeShaderReflection.h"
 
 #include <vulkan/vulkan.h>
 
 #include <string>
 #include <array>
-
-#include <shaderc/shaderc.hpp>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
 
 namespace forge
 {
 	struct Forge;
 	struct ForgeRenderPass;
+	struct ForgeShaderArchive;
 
 	static constexpr uint32_t FORGE_SHADER_MAX_INPUT_ATTRIBUTES = 16u;
 	static constexpr uint32_t FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS = 8u;
 	static constexpr uint32_t FORGE_SHADER_MAX_IMAGES = 16u;
+	static constexpr uint32_t FORGE_SHADER_MAX_STORAGE_BUFFERS = 8u;
+	static constexpr uint32_t FORGE_SHADER_MAX_SETS = 4u; // maxBoundDescriptorSets is at least 4 on every device
+	static constexpr uint32_t FORGE_SHADER_MAX_SET_DESCRIPTORS = FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS + FORGE_SHADER_MAX_IMAGES + FORGE_SHADER_MAX_STORAGE_BUFFERS;
 
 	enum FORGE_SHADER_STAGE
 	{
 		FORGE_SHADER_STAGE_VERTEX,
 		FORGE_SHADER_STAGE_FRAGMENT,
+		FORGE_SHADER_STAGE_COMPUTE, // Values match shaderc_shader_kind
 		FORGE_SHADER_STAGE_COUNT,
 	};
 
+	// Resources are meant to be split across sets by how often they change, a set whose resources didn't change since
+	// the last draw isn't updated nor rebound. Bindings stay unique across the sets of a shader since binding lists
+	// address resources by binding alone.
+	enum FORGE_SHADER_SET
+	{
+		FORGE_SHADER_SET_FRAME,
+		FORGE_SHADER_SET_PASS,
+		FORGE_SHADER_SET_MATERIAL,
+		FORGE_SHADER_SET_DRAW, // Taken by the bindless table in shaders that sample it, per draw data goes through push constants there
+	};
+
 	struct ForgeInputAttributeDescription
 	{
 		std::string name;
@@ -34,6 +53,23 @@ namespace forge
 	};
 
 	struct ForgeUniformBlockDescription
+	{
+		std::string name;
+		uint32_t size;
+		uint32_t set;
+		VkShaderStageFlags stages;
+	};
+
+	struct ForgeStorageBufferDescription
+	{
+		std::string name;
+		uint32_t size; // Declared size, a trailing runtime array counts as empty
+		uint32_t set;
+		VkShaderStageFlags stages;
+		bool readonly;
+	};
+
+	struct ForgePushConstantDescription
 	{
 		std::string name;
 		uint32_t size;
@@ -43,6 +79,7 @@ namespace forge
 	struct ForgeShaderImageDescription
 	{
 		std::string name;
+		uint32_t set;
 		VkShaderStageFlags stages;
 		bool storage;
 	};
@@ -66,28 +103,101 @@ namespace forge
 		ForgeInputAttributeDescription attributes[FORGE_SHADER_MAX_INPUT_ATTRIBUTES];
 		ForgeUniformBlockDescription uniforms[FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS];
 		ForgeShaderImageDescription images[FORGE_SHADER_MAX_IMAGES];
+		ForgeStorageBufferDescription storage_buffers[FORGE_SHADER_MAX_STORAGE_BUFFERS];
+		ForgePushConstantDescription push_constants; // A single block shared by every stage that declares it
+	};
+
+	enum FORGE_SHADER_PIPELINE_STATE
+	{
+		FORGE_SHADER_PIPELINE_STATE_COMPILING,
+		FORGE_SHADER_PIPELINE_STATE_READY,
+		FORGE_SHADER_PIPELINE_STATE_FAILED,
+	};
+
+	struct ForgeShaderPipeline
+	{
+		VkPipeline handle;
+		FORGE_SHADER_PIPELINE_STATE state;
+	};
+
+	struct ForgeShaderSource
+	{
+		const char* name;
+		const char* source_code;
+		ForgePipelineDescription pipeline_description; // Ignored by compute shaders
+		bool compute;
+		std::vector<std::string> macros; // Keywords of a permutation, see ForgeShaderPermutations
+		std::vector<VkSpecializationMapEntry> specialization_entries;
+		std::vector<uint32_t> specialization_data;
+	};
+
+	// Descriptor update templates read one entry per descriptor of a set out of a packed payload
+	union ForgeDescriptorPayloadEntry
+	{
+		VkDescriptorBufferInfo buffer;
+		VkDescriptorImageInfo image;
 	};
 
 	struct ForgeShader
 	{
-		VkPipeline pipeline;
+		VkPipeline pipeline; // Compute only, created up front
+		std::unordered_map<uint64_t, ForgeShaderPipeline> pipelines; // Graphics, keyed by pipeline description and render pass compatibility
+		uint64_t pipeline_description_hash;
+		uint32_t pipelines_compiling; // Jobs still referencing the shader
+		std::condition_variable pipelines_compiled;
 		VkPipelineLayout pipeline_layout;
-		VkDescriptorSetLayout descriptor_set_layout;
+		VkDescriptorSetLayout descriptor_set_layouts[FORGE_SHADER_MAX_SETS]; // Sets below sets_count without resources get an empty layout
+		VkDescriptorUpdateTemplate descriptor_update_templates[FORGE_SHADER_MAX_SETS]; // Only for sets with resources
+		std::vector<VkDescriptorSetLayoutBinding> set_bindings[FORGE_SHADER_MAX_SETS]; // In the order of the template's payload
+		uint32_t sets_count;
 		VkShaderModule modules[FORGE_SHADER_STAGE_COUNT];
-		VkRenderPass active_pass;
-		shaderc::SpvCompilationResult spirv[FORGE_SHADER_STAGE_COUNT];
-		uint32_t uniform_offsets[FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS];
-		uint32_t uniforms_count;
+		std::vector<uint32_t> spirv[FORGE_SHADER_STAGE_COUNT];
+		ForgeShaderReflection reflections[FORGE_SHADER_STAGE_COUNT];
+		std::vector<std::string> macros; // Defined on top of the stage macro when compiling
+		std::vector<VkSpecializationMapEntry> specialization_entries; // Applied to every stage of every pipeline
+		std::vector<uint32_t> specialization_data;
+		bool bindless; // Samples the bindless table at FORGE_BINDLESS_SET
+		bool push_descriptors; // Its FORGE_SHADER_SET_DRAW set is pushed into the command buffer instead of allocated
 		ForgeShaderDescription description;
 		ForgePipelineDescription pipeline_description;
+		std::mutex mutex; // Guards the pipelines, frames recorded on different threads might share the shader
 	};
 
-	bool
-	_forge_shader_pipeline_init(Forge* forge, ForgeShader* shader, VkRenderPass pass);
+	// Returns the state of the graphics pipeline for render passes compatible with 'pass' and starts compiling it if it
+	// wasn't requested yet, on the worker pool if there's one. Pipelines are kept for the shader's lifetime so switching
+	// or resizing passes doesn't recompile.
+	FORGE_SHADER_PIPELINE_STATE
+	forge_shader_pipeline_request(Forge* forge, ForgeShader* shader, ForgeRenderPass* pass);
+
+	// Returns the pipeline if it's ready, VK_NULL_HANDLE while it's compiling or if it failed. Meant for a fallback
+	// shader to be bound in the meantime.
+	VkPipeline
+	forge_shader_pipeline_get(Forge* forge, ForgeShader* shader, ForgeRenderPass* pass);
+
+	// Blocks until the pipeline is compiled, e.g. to warm up the pipelines of a loading screen
+	VkPipeline
+	forge_shader_pipeline_wait(Forge* forge, ForgeShader* shader, ForgeRenderPass* pass);
 
 	ForgeShader*
 	forge_shader_new(Forge* forge, ForgePipelineDescription pipeline_description, const char* name, const char* shader_source_code);
 
+	// Compiles the source with COMPUTE_SHADER defined, resources are reflected the same way graphics shaders are
+	ForgeShader*
+	forge_compute_shader_new(Forge* forge, const char* name, const char* shader_source_code);
+
+	// Loads precompiled stages and their reflection out of an archive written by ForgeShaderCompiler, nothing is compiled
+	// nor reflected at runtime. 'variant' is the key the compiler was given with --variant, zero for plain sources.
+	ForgeShader*
+	forge_shader_new(Forge* forge, ForgePipelineDescription pipeline_description, ForgeShaderArchive* archive, const char* name, uint64_t variant = 0u);
+
+	ForgeShader*
+	forge_compute_shader_new(Forge* forge, ForgeShaderArchive* archive, const char* name, uint64_t variant = 0u);
+
+	// Compiles and reflects the sources on 'threads_count' threads, zero uses one per core, and then creates the Vulkan
+	// objects on the calling thread. Returns false if any shader failed, its slot in 'shaders' is left null.
+	bool
+	forge_shader_new_batch(Forge* forge, const ForgeShaderSource* sources, uint32_t count, uint32_t threads_count, ForgeShader** shaders);
+
 	void
 	forge_shader_destroy(Forge* forge, ForgeShader* shader);
 };
\ No newline at end of file
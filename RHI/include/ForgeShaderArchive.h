@@ -0,0 +1,75 @@
+#pragma once
+
+#include "ForgeShader.h"
+#include "ForgeShaderReflection.h"
+
+#include <string>
+#include <vector>
+
+namespace forge
+{
+	struct Forge;
+
+	static constexpr uint32_t FORGE_SHADER_ARCHIVE_MAGIC = 0x52415346u; // "FSAR"
+	static constexpr uint32_t FORGE_SHADER_ARCHIVE_VERSION = 1u;
+
+	struct ForgeShaderArchiveHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entries_count;
+		uint32_t reserved;
+	};
+
+	// Offsets are relative to the start of the file, SPIR-V is 4 bytes aligned so modules are created straight out of
+	// the mapping
+	struct ForgeShaderArchiveEntry
+	{
+		uint64_t key; // Shader name and variant
+		uint32_t stage;
+		uint32_t spirv_offset;
+		uint32_t spirv_size;
+		uint32_t reflection_offset;
+		uint32_t reflection_size;
+		uint32_t reserved;
+	};
+
+	// One stage of one shader variant, the input of forge_shader_archive_write
+	struct ForgeShaderArchiveSource
+	{
+		std::string name;
+		uint64_t variant;
+		FORGE_SHADER_STAGE stage;
+		std::vector<uint32_t> spirv;
+		ForgeShaderReflection reflection;
+	};
+
+	// A read only, memory mapped file of precompiled shaders written by ForgeShaderCompiler. Entries are sorted by key and
+	// stage so lookups are a binary search over the mapping. Shaders don't reference the archive once they're created.
+	struct ForgeShaderArchive
+	{
+		const uint8_t* data;
+		size_t size;
+		const ForgeShaderArchiveHeader* header;
+		const ForgeShaderArchiveEntry* entries;
+		void* file; // Win32 only
+		void* mapping; // Win32 only
+	};
+
+	ForgeShaderArchive*
+	forge_shader_archive_new(Forge* forge, const char* path);
+
+	uint64_t
+	forge_shader_archive_key(const char* name, uint64_t variant);
+
+	// Returns nullptr if the archive doesn't hold that stage of the shader
+	const ForgeShaderArchiveEntry*
+	forge_shader_archive_find(Forge* forge, ForgeShaderArchive* archive, const char* name, uint64_t variant, FORGE_SHADER_STAGE stage);
+
+	// Doesn't need a device, the offline compiler calls it without one
+	bool
+	forge_shader_archive_write(Forge* forge, const char* path, const std::vector<ForgeShaderArchiveSource>& sources);
+
+	void
+	forge_shader_archive_destroy(Forge* forge, ForgeShaderArchive* archive);
+};
\ No newline at end of file
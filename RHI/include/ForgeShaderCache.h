@@ -0,0 +1,54 @@
+#pragma once
+
+#include "ForgeShaderReflection.h"
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+#include <shaderc/shaderc.hpp>
+
+namespace forge
+{
+	struct Forge;
+
+	// Bump whenever the way sources are compiled changes in a way the key doesn't capture, shaderc doesn't report its
+	// own version so that includes upgrading it outside of a Vulkan SDK update
+	static constexpr uint32_t FORGE_SHADER_CACHE_VERSION = 1u;
+
+	struct ForgeShaderCacheEntry
+	{
+		std::vector<uint32_t> spirv;
+		ForgeShaderReflection reflection;
+	};
+
+	// Content addressed GLSL to SPIR-V cache, entries are keyed by the source, the stage, the macros, the compile options,
+	// the SPIR-V version shaderc targets, the Vulkan SDK headers and FORGE_SHADER_CACHE_VERSION. Entries live in memory and optionally in a directory on disk, one file per entry
+	// plus its reflection record.
+	// Compiling is thread safe, shaderc compilers can be shared between threads and the mutex guards the rest.
+	struct ForgeShaderCache
+	{
+		shaderc::Compiler compiler;
+		std::string directory;
+		std::unordered_map<uint64_t, ForgeShaderCacheEntry> entries;
+		uint64_t compiler_hash;
+		uint32_t memory_hits;
+		uint32_t disk_hits;
+		uint32_t misses;
+		std::mutex mutex;
+	};
+
+	// An empty directory keeps the cache in memory only
+	ForgeShaderCache*
+	forge_shader_cache_new(Forge* forge, const std::string& directory);
+
+	// Returns the SPIR-V and its reflection record, spirv-cross only runs when the cache has no up to date record
+	bool
+	forge_shader_cache_compile(Forge* forge, ForgeShaderCache* cache, shaderc_shader_kind kind, const char* name, const char* source, const std::vector<std::string>& macros, std::vector<uint32_t>* spirv, ForgeShaderReflection* reflection);
+
+	void
+	forge_shader_cache_destroy(Forge* forge, ForgeShaderCache* cache);
+};
\ No newline at end of file
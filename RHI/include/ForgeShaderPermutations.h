@@ -0,0 +1,68 @@
+#pragma once
+
+#include "ForgeShader.h"
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+
+namespace forge
+{
+	struct Forge;
+
+	static constexpr uint32_t FORGE_SHADER_MAX_KEYWORDS = 64u; // One bit each in a permutation key
+
+	// A keyword is either a macro, defined when its bit is set and costing a compilation per combination, or a boolean
+	// specialization constant declared as 'layout(constant_id = N) const bool NAME = false;' which reuses the SPIR-V
+	// and only changes the pipelines. Specialization constants should be preferred whenever the keyword doesn't change
+	// the shader's resources or interface.
+	struct ForgeShaderKeyword
+	{
+		std::string name;
+		bool specialization;
+		uint32_t constant_id;
+	};
+
+	struct ForgeShaderPermutationsDescription
+	{
+		std::string name;
+		std::string source_code;
+		ForgePipelineDescription pipeline_description; // Ignored by compute shaders
+		bool compute;
+		std::vector<ForgeShaderKeyword> keywords; // Bit i of a key enables keyword i
+	};
+
+	// Variants of one source addressed by a bitmask of keywords, each variant is a shader of its own created on first
+	// use or ahead of time in batches. Variants are always compiled from source through the shader cache, archives
+	// aren't consulted: ForgeShaderCompiler can store one with --variant=<key>:<macro keywords> to be loaded with the
+	// archive overload of forge_shader_new, but its specialization keywords are then left at their defaults.
+	struct ForgeShaderPermutations
+	{
+		ForgeShaderPermutationsDescription description;
+		std::unordered_map<uint64_t, ForgeShader*> variants; // Null for variants that failed, they aren't compiled again
+		uint64_t keywords_mask;
+		std::mutex mutex; // Guards the variants, frames recorded on different threads might share the permutations
+	};
+
+	ForgeShaderPermutations*
+	forge_shader_permutations_new(Forge* forge, const ForgeShaderPermutationsDescription& description);
+
+	// Returns the key with the bits of the named keywords set, unknown names are reported and ignored
+	uint64_t
+	forge_shader_permutations_key(Forge* forge, ForgeShaderPermutations* permutations, const std::vector<std::string>& keywords);
+
+	// Creates the variant on first use, returns nullptr if it failed to compile now or on an earlier call
+	ForgeShader*
+	forge_shader_permutations_get(Forge* forge, ForgeShaderPermutations* permutations, uint64_t key);
+
+	// Creates the missing variants of 'keys' in parallel, see forge_shader_new_batch. Returns false if any of them failed,
+	// now or on an earlier call.
+	bool
+	forge_shader_permutations_compile(Forge* forge, ForgeShaderPermutations* permutations, const uint64_t* keys, uint32_t count, uint32_t threads_count = 0u);
+
+	void
+	forge_shader_permutations_destroy(Forge* forge, ForgeShaderPermutations* permutations);
+};
\ No newline at end of file
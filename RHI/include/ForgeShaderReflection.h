@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <vector>
+
+namespace forge
+{
+	struct Forge;
+
+	// Bump whenever the record layout or what gets reflected changes, stale records are then reflected again
+	static constexpr uint32_t FORGE_SHADER_REFLECTION_VERSION = 1u;
+
+	enum FORGE_SHADER_REFLECTION_KIND
+	{
+		FORGE_SHADER_REFLECTION_KIND_INPUT,
+		FORGE_SHADER_REFLECTION_KIND_UNIFORM_BUFFER,
+		FORGE_SHADER_REFLECTION_KIND_SAMPLED_IMAGE,
+		FORGE_SHADER_REFLECTION_KIND_STORAGE_IMAGE,
+		FORGE_SHADER_REFLECTION_KIND_STORAGE_BUFFER,
+		FORGE_SHADER_REFLECTION_KIND_PUSH_CONSTANTS,
+		FORGE_SHADER_REFLECTION_KIND_BINDLESS_TABLE,
+		FORGE_SHADER_REFLECTION_KIND_COUNT,
+	};
+
+	struct ForgeShaderReflectionResource
+	{
+		std::string name;
+		FORGE_SHADER_REFLECTION_KIND kind;
+		uint32_t set;
+		uint32_t binding; // The location of inputs
+		uint32_t size;
+		uint32_t value; // The VkFormat of inputs, whether storage buffers are read only
+	};
+
+	// Everything a shader needs out of the SPIR-V of one stage, gathered in a single pass and compact enough to be stored
+	// next to the SPIR-V in the shader cache so loading doesn't need spirv-cross
+	struct ForgeShaderReflection
+	{
+		std::vector<ForgeShaderReflectionResource> resources;
+	};
+
+	// Only available when built with FORGE_SPIRV_CROSS, fails otherwise
+	bool
+	forge_shader_reflection_init(Forge* forge, const std::vector<uint32_t>& spirv, ForgeShaderReflection* reflection);
+
+	void
+	forge_shader_reflection_serialize(Forge* forge, const ForgeShaderReflection& reflection, std::vector<uint8_t>* blob);
+
+	// Rejects truncated records, records written by another version and resources outside of the shader limits
+	bool
+	forge_shader_reflection_deserialize(Forge* forge, const uint8_t* data, size_t size, ForgeShaderReflection* reflection);
+};
\ No newline at end of file
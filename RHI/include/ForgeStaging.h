@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+namespace forge
+{
+	struct Forge;
+	struct ForgeBuffer;
+
+	static constexpr uint32_t FORGE_STAGING_MAX_REGIONS = 4u;
+
+	struct ForgeStagingRegion
+	{
+		VkCommandBuffer command_buffer;
+		uint32_t offset;
+		uint32_t cursor;
+		uint64_t release_signal;
+		bool recording;
+	};
+
+	// A ring of staging memory split into regions, every region records its copies into its own command buffer which
+	// is submitted asynchronously and fenced by the staging timeline, the CPU only waits when it wraps around to a region
+	// the GPU didn't consume yet.
+	// Uploads are not thread safe, they must be issued from the thread that calls forge_flush.
+	struct ForgeStaging
+	{
+		ForgeBuffer* buffer;
+		VkCommandPool pool;
+		VkSemaphore timeline;
+		uint64_t timeline_next_signal;
+		uint64_t timeline_submitted_signal;
+		uint32_t region_size;
+		uint32_t current;
+		ForgeStagingRegion regions[FORGE_STAGING_MAX_REGIONS];
+	};
+
+	ForgeStaging*
+	forge_staging_new(Forge* forge, uint32_t size);
+
+	// Reserves 'size' bytes of staging memory at 'offset', copies out of it must be recorded into the returned command buffer
+	VkCommandBuffer
+	forge_staging_reserve(Forge* forge, ForgeStaging* staging, uint32_t size, uint32_t alignment, uint32_t* offset);
+
+	// Submits the pending uploads and returns the timeline value that gets signaled once they're done
+	uint64_t
+	forge_staging_submit(Forge* forge, ForgeStaging* staging);
+
+	bool
+	forge_staging_complete(Forge* forge, ForgeStaging* staging, uint64_t signal);
+
+	void
+	forge_staging_wait(Forge* forge, ForgeStaging* staging, uint64_t signal);
+
+	void
+	forge_staging_destroy(Forge* forge, ForgeStaging* staging);
+};
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include <vulkan/vulkan.h>
 
 #include <vector>
+#include <cstring>
 #include <assert.h>
 
 namespace forge
@@ -33,6 +34,20 @@ namespace forge
 		seed ^= hasher(v) + 0x9e3779b9u + (seed << 6u) + (seed >> 2u);
 	}
 
+	// FNV-1a, stable across runs and platforms unlike std::hash so it can be used to key data on disk
+	static uint64_t
+	_forge_hash_bytes(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ull)
+	{
+		auto bytes = (const uint8_t*)data;
+		for (size_t i = 0; i < size; ++i)
+		{
+			seed ^= bytes[i];
+			seed *= 0x100000001b3ull;
+		}
+
+		return seed;
+	}
+
 	inline static VkAccessFlags
 	_forge_image_memory_barrier_src_access(VkImageLayout layout)
 	{
@@ -151,6 +166,18 @@ namespace forge
 		return stage;
 	}
 
+	static VkPipelineStageFlags
+	_forge_shader_stages_pipeline_stage(VkShaderStageFlags stages)
+	{
+		VkPipelineStageFlags stage {};
+
+		if (stages & VK_SHADER_STAGE_VERTEX_BIT) stage |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+		if (stages & VK_SHADER_STAGE_FRAGMENT_BIT) stage |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		if (stages & VK_SHADER_STAGE_COMPUTE_BIT) stage |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+		return stage;
+	}
+
 	template<typename T>
 	inline static VkObjectType
 	_vk_object_type()
@@ -175,6 +202,7 @@ namespace forge
 		else if constexpr (std::is_same_v<T, VkSampler>) return VK_OBJECT_TYPE_SAMPLER;
 		else if constexpr (std::is_same_v<T, VkDescriptorPool>) return VK_OBJECT_TYPE_DESCRIPTOR_POOL;
 		else if constexpr (std::is_same_v<T, VkDescriptorSet>) return VK_OBJECT_TYPE_DESCRIPTOR_SET;
+		else if constexpr (std::is_same_v<T, VkDescriptorUpdateTemplate>) return VK_OBJECT_TYPE_DESCRIPTOR_UPDATE_TEMPLATE;
 		else if constexpr (std::is_same_v<T, VkFramebuffer>) return VK_OBJECT_TYPE_FRAMEBUFFER;
 		else if constexpr (std::is_same_v<T, VkCommandPool>) return VK_OBJECT_TYPE_COMMAND_POOL;
 		else if constexpr (std::is_same_v<T, VkSwapchainKHR>) return VK_OBJECT_TYPE_SWAPCHAIN_KHR;
@@ -209,6 +237,7 @@ namespace forge
 		case VK_OBJECT_TYPE_SAMPLER: return "SAMPLER";
 		case VK_OBJECT_TYPE_DESCRIPTOR_POOL: return "DESCRIPTOR POOL";
 		case VK_OBJECT_TYPE_DESCRIPTOR_SET: return "DESCRIPTOR SET";
+		case VK_OBJECT_TYPE_DESCRIPTOR_UPDATE_TEMPLATE: return "DESCRIPTOR UPDATE TEMPLATE";
 		case VK_OBJECT_TYPE_FRAMEBUFFER: return "FRAMEBUFFER";
 		case VK_OBJECT_TYPE_COMMAND_POOL: return "COMMAND POOL";
 		case VK_OBJECT_TYPE_SURFACE_KHR: return "SURFACE";
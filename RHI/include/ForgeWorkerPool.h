@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+
+namespace forge
+{
+	struct Forge;
+
+	// A fixed set of threads running jobs in submission order, used for work that would otherwise stall recording
+	// (e.g. pipeline compilation). Jobs must not record or submit command buffers.
+	struct ForgeWorkerPool
+	{
+		std::vector<std::thread> threads;
+		std::deque<std::function<void()>> jobs;
+		uint32_t running; // Jobs popped but not finished yet
+		bool stopping;
+		std::mutex mutex;
+		std::condition_variable job_available;
+		std::condition_variable idle;
+	};
+
+	ForgeWorkerPool*
+	forge_worker_pool_new(Forge* forge, uint32_t threads_count);
+
+	void
+	forge_worker_pool_push(Forge* forge, ForgeWorkerPool* pool, std::function<void()> job);
+
+	// Blocks until every pushed job is done
+	void
+	forge_worker_pool_wait(Forge* forge, ForgeWorkerPool* pool);
+
+	// Pending jobs still run before the threads are joined
+	void
+	forge_worker_pool_destroy(Forge* forge, ForgeWorkerPool* pool);
+};
\ No newline at end of file
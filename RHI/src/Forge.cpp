@@ -12,8 +12,17 @@
 #include "ForgeDeletionQueue.h"
 #include "ForgeDescriptorSetManager.h"
 #include "ForgeCommandBufferManager.h"
-
+#include "ForgeMemoryAllocator.h"
+#include "ForgeStaging.h"
+#include "ForgePipelineCache.h"
+#include "ForgeBindless.h"
+#include "ForgeSampler.h"
+#include "ForgeWorkerPool.h"
+#include "ForgeShaderCache.h"
+
+#ifdef VK_USE_PLATFORM_WIN32_KHR
 #include <vulkan/vulkan_win32.h>
+#endif
 
 #include <vector>
 
@@ -39,12 +48,19 @@ namespace forge
 	#endif
 
 		uint32_t extensions_count = 0u;
-		const char* extensions[] = {
-			VK_KHR_SURFACE_EXTENSION_NAME,
-			VK_KHR_WIN32_SURFACE_EXTENSION_NAME,
-			VK_EXT_DEBUG_UTILS_EXTENSION_NAME
-		};
-		extensions_count = sizeof(extensions) / sizeof(extensions[0]);
+		const char* extensions[3] = {};
+		extensions[extensions_count++] = VK_EXT_DEBUG_UTILS_EXTENSION_NAME;
+
+		if (forge->description.headless == false)
+		{
+		#ifdef VK_USE_PLATFORM_WIN32_KHR
+			extensions[extensions_count++] = VK_KHR_SURFACE_EXTENSION_NAME;
+			extensions[extensions_count++] = VK_KHR_WIN32_SURFACE_EXTENSION_NAME;
+		#else
+			log_error("Platform doesn't support presentation, only headless mode is available");
+			return false;
+		#endif
+		}
 
 		uint32_t supported_version = VK_API_VERSION_1_0;
 		vkEnumerateInstanceVersion(&supported_version);
@@ -150,13 +166,16 @@ namespace forge
 				if (queue_family_properties.queueCount > 0 &&
 					queue_family_properties.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))
 				{
-					VkBool32 supports_present;
-				#ifdef VK_USE_PLATFORM_WIN32_KHR
-					supports_present = vkGetPhysicalDeviceWin32PresentationSupportKHR(physical_device, j);
-				#elif
-					log_error("Platform is not supported");
-					return false;
-				#endif
+					VkBool32 supports_present = VK_TRUE;
+					if (forge->description.headless == false)
+					{
+					#ifdef VK_USE_PLATFORM_WIN32_KHR
+						supports_present = vkGetPhysicalDeviceWin32PresentationSupportKHR(physical_device, j);
+					#else
+						log_error("Platform is not supported");
+						return false;
+					#endif
+					}
 
 					if (supports_present)
 					{
@@ -214,10 +233,25 @@ namespace forge
 		VkResult res;
 
 		uint32_t extensions_count = 0;
-		const char* extensions[] = {
-			VK_KHR_SWAPCHAIN_EXTENSION_NAME
-		};
-		extensions_count = sizeof(extensions) / sizeof(extensions[0]);
+		const char* extensions[2] = {};
+
+		if (forge->description.headless == false)
+		{
+			extensions[extensions_count++] = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+		}
+
+		if (forge->description.push_descriptors)
+		{
+			if (_forge_device_extension_support(forge, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME))
+			{
+				extensions[extensions_count++] = VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME;
+			}
+			else
+			{
+				log_warning("Push descriptors were requested but the device doesn't support '{}'", VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+				forge->description.push_descriptors = false;
+			}
+		}
 
 		for (uint32_t i = 0; i < extensions_count; ++i)
 		{
@@ -238,12 +272,56 @@ namespace forge
 		queue_info.queueCount = 1u;
 		queue_info.pQueuePriorities = queue_priorites;
 
-		VkPhysicalDeviceFeatures device_features {};
+		VkPhysicalDeviceVulkan12Features supported_features_12 {};
+		supported_features_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
 
-		// Enable timeline semaphore feature
-		VkPhysicalDeviceTimelineSemaphoreFeatures timeline_semaphore_features {};
-		timeline_semaphore_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
-		timeline_semaphore_features.timelineSemaphore = VK_TRUE;
+		VkPhysicalDeviceFeatures2 supported_features {};
+		supported_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		supported_features.pNext = &supported_features_12;
+		vkGetPhysicalDeviceFeatures2(forge->physical_device, &supported_features);
+
+		if (supported_features_12.timelineSemaphore == VK_FALSE)
+		{
+			log_error("Required device feature 'timelineSemaphore' is not supported");
+			return false;
+		}
+
+		VkPhysicalDeviceFeatures device_features {};
+		// Optional, indirect draws fall back to one call per command without it
+		device_features.multiDrawIndirect = supported_features.features.multiDrawIndirect;
+		// Optional, GPU culling is unavailable without it since its draws carry the object id as firstInstance
+		device_features.drawIndirectFirstInstance = supported_features.features.drawIndirectFirstInstance;
+		// Optional, samplers clamp their anisotropy to 1 without it
+		device_features.samplerAnisotropy = supported_features.features.samplerAnisotropy;
+
+		VkPhysicalDeviceVulkan12Features features_12 {};
+		features_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		features_12.timelineSemaphore = VK_TRUE;
+		// Optional, count draws are rejected without it
+		features_12.drawIndirectCount = supported_features_12.drawIndirectCount;
+
+		if (forge->description.bindless)
+		{
+			bool bindless_supported =
+				supported_features_12.runtimeDescriptorArray &&
+				supported_features_12.descriptorBindingPartiallyBound &&
+				supported_features_12.descriptorBindingSampledImageUpdateAfterBind &&
+				supported_features_12.shaderSampledImageArrayNonUniformIndexing;
+
+			if (bindless_supported)
+			{
+				features_12.descriptorIndexing = supported_features_12.descriptorIndexing;
+				features_12.runtimeDescriptorArray = VK_TRUE;
+				features_12.descriptorBindingPartiallyBound = VK_TRUE;
+				features_12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+				features_12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+			}
+			else
+			{
+				log_warning("Bindless was requested but the device doesn't support the required descriptor indexing features");
+				forge->description.bindless = false;
+			}
+		}
 
 		VkDeviceCreateInfo device_info{};
 		device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -252,7 +330,7 @@ namespace forge
 		device_info.enabledExtensionCount = extensions_count;
 		device_info.ppEnabledExtensionNames = extensions;
 		device_info.pEnabledFeatures = &device_features;
-		device_info.pNext = &timeline_semaphore_features;
+		device_info.pNext = &features_12;
 		res = vkCreateDevice(forge->physical_device, &device_info, nullptr, &forge->device);
 		VK_RES_CHECK(res);
 
@@ -267,6 +345,25 @@ namespace forge
 
 		vkGetDeviceQueue(forge->device, forge->queue_family_index, 0u, &forge->queue);
 
+		if (forge->description.push_descriptors)
+		{
+			forge->pfn_vkCmdPushDescriptorSetWithTemplateKHR = (PFN_vkCmdPushDescriptorSetWithTemplateKHR)vkGetDeviceProcAddr(forge->device, "vkCmdPushDescriptorSetWithTemplateKHR");
+		}
+
+		forge->physical_device_features = device_features;
+		forge->physical_device_features_12 = features_12;
+		forge->physical_device_features_12.pNext = nullptr;
+
+		log_info(
+			"Optional device features multiDrawIndirect '{}' drawIndirectFirstInstance '{}' samplerAnisotropy '{}' drawIndirectCount '{}' bindless '{}' push descriptors '{}'",
+			(bool)device_features.multiDrawIndirect,
+			(bool)device_features.drawIndirectFirstInstance,
+			(bool)device_features.samplerAnisotropy,
+			(bool)features_12.drawIndirectCount,
+			forge->description.bindless,
+			forge->description.push_descriptors
+		);
+
 		log_info("Device and Queue were created successfully");
 
 		return true;
@@ -327,31 +424,12 @@ namespace forge
 	}
 
 	static bool
-	_forge_staging_buffer_init(Forge* forge)
+	_forge_staging_init(Forge* forge)
 	{
-		ForgeBufferDescription desc {};
-		desc.name = "Forge staging buffer";
-		desc.size = STAGING_BUFFER_SIZE;
-		desc.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-		desc.memory_properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-		forge->staging_buffer = forge_buffer_new(forge, desc);
-		if (forge->staging_buffer == nullptr)
-		{
-			return false;
-		}
-
-		log_info("A '{}' bytes of global staging memory was created successfully", STAGING_BUFFER_SIZE);
-
-		VkCommandBufferAllocateInfo info {};
-		info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		info.commandBufferCount = 1u;
-		info.commandPool = forge->command_buffer_manager->pool;
-		auto res = vkAllocateCommandBuffers(forge->device, &info, &forge->staging_command_buffer);
-		VK_RES_CHECK(res);
-
-		if (res != VK_SUCCESS)
+		forge->staging = forge_staging_new(forge, STAGING_BUFFER_SIZE);
+		if (forge->staging == nullptr)
 		{
-			log_error("Failed to create the global staging command buffer");
+			log_error("Failed to initialize the staging memory");
 			return false;
 		}
 
@@ -401,7 +479,23 @@ namespace forge
 			return false;
 		}
 
-		// FIXME: Need to be initialized before the staging command buffer
+		// Needs to be initialized before any resource is created since it owns their deferred destruction
+		forge->deletion_queue = forge_deletion_queue_new(forge);
+		if (forge->deletion_queue == nullptr)
+		{
+			log_error("Failed to initialize the deletion queue");
+			forge_destroy(forge);
+			return false;
+		}
+
+		forge->memory_allocator = forge_memory_allocator_new(forge);
+		if (forge->memory_allocator == nullptr)
+		{
+			log_error("Failed to initialize the memory allocator");
+			forge_destroy(forge);
+			return false;
+		}
+
 		forge->command_buffer_manager = forge_command_buffer_manager_new(forge);
 		if (forge->command_buffer_manager == nullptr)
 		{
@@ -410,7 +504,7 @@ namespace forge
 			return false;
 		}
 
-		if (_forge_staging_buffer_init(forge) == false)
+		if (_forge_staging_init(forge) == false)
 		{
 			forge_destroy(forge);
 			return false;
@@ -422,22 +516,61 @@ namespace forge
 			return false;
 		}
 
-		forge->deletion_queue = forge_deletion_queue_new(forge);
-		if (forge->deletion_queue == nullptr)
+		forge->descriptor_set_manager = forge_descriptor_set_manager_new(forge);
+		if (forge->descriptor_set_manager == nullptr)
 		{
-			log_error("Failed to initialize the deletion queue");
+			log_error("Failed to initialize the descriptor set manager");
 			forge_destroy(forge);
 			return false;
 		}
 
-		forge->descriptor_set_manager = forge_descriptor_set_manager_new(forge);
-		if (forge->descriptor_set_manager == nullptr)
+		forge->sampler_cache = forge_sampler_cache_new(forge);
+		if (forge->sampler_cache == nullptr)
 		{
-			log_error("Failed to initialize the descriptor set manager");
+			log_error("Failed to initialize the sampler cache");
 			forge_destroy(forge);
 			return false;
 		}
 
+		// Images register themselves into the table on creation, it has to exist before the first one
+		if (forge->description.bindless)
+		{
+			forge->bindless_table = forge_bindless_table_new(forge);
+			if (forge->bindless_table == nullptr)
+			{
+				log_error("Failed to initialize the bindless table");
+				forge_destroy(forge);
+				return false;
+			}
+		}
+
+		forge->pipeline_cache = forge_pipeline_cache_new(forge, forge->description.pipeline_cache_path);
+		if (forge->pipeline_cache == nullptr)
+		{
+			log_error("Failed to initialize the pipeline cache");
+			forge_destroy(forge);
+			return false;
+		}
+
+		forge->shader_cache = forge_shader_cache_new(forge, forge->description.shader_cache_directory);
+		if (forge->shader_cache == nullptr)
+		{
+			log_error("Failed to initialize the shader cache");
+			forge_destroy(forge);
+			return false;
+		}
+
+		if (forge->description.pipeline_worker_threads > 0u)
+		{
+			forge->worker_pool = forge_worker_pool_new(forge, forge->description.pipeline_worker_threads);
+			if (forge->worker_pool == nullptr)
+			{
+				log_error("Failed to initialize the worker pool");
+				forge_destroy(forge);
+				return false;
+			}
+		}
+
 		VkSemaphoreTypeCreateInfo timeline_info {};
 		timeline_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
 		timeline_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
@@ -465,6 +598,13 @@ namespace forge
 	static void
 	_forge_free(Forge* forge)
 	{
+		// Jobs might still be creating objects with the device
+		if (forge->worker_pool)
+		{
+			forge_worker_pool_destroy(forge, forge->worker_pool);
+			forge->worker_pool = nullptr;
+		}
+
 		if (forge->device)
 		{
 			vkDeviceWaitIdle(forge->device);
@@ -490,9 +630,19 @@ namespace forge
 			forge_descriptor_set_manager_destroy(forge, forge->descriptor_set_manager);
 		}
 
-		if (forge->staging_buffer)
+		if (forge->shader_cache)
 		{
-			forge_buffer_destroy(forge, forge->staging_buffer);
+			forge_shader_cache_destroy(forge, forge->shader_cache);
+		}
+
+		if (forge->pipeline_cache)
+		{
+			forge_pipeline_cache_destroy(forge, forge->pipeline_cache);
+		}
+
+		if (forge->staging)
+		{
+			forge_staging_destroy(forge, forge->staging);
 		}
 
 		if (forge->uniform_memory)
@@ -500,8 +650,26 @@ namespace forge
 			forge_dynamic_memory_destroy(forge, forge->uniform_memory);
 		}
 
-		forge_deletion_queue_flush(forge, forge->deletion_queue, true);
-		forge_deletion_queue_destroy(forge, forge->deletion_queue);
+		if (forge->deletion_queue)
+		{
+			forge_deletion_queue_flush(forge, forge->deletion_queue, true);
+			forge_deletion_queue_destroy(forge, forge->deletion_queue);
+		}
+
+		if (forge->bindless_table)
+		{
+			forge_bindless_table_destroy(forge, forge->bindless_table);
+		}
+
+		if (forge->sampler_cache)
+		{
+			forge_sampler_cache_destroy(forge, forge->sampler_cache);
+		}
+
+		if (forge->memory_allocator)
+		{
+			forge_memory_allocator_destroy(forge, forge->memory_allocator);
+		}
 
 		if (forge->device)
 		{
@@ -514,15 +682,34 @@ namespace forge
 		}
 	}
 
+	static void
+	_forge_frames_throttle(Forge* forge)
+	{
+		// Without a swapchain there are no fences pacing the CPU, keep it at most FORGE_SWAPCHIAN_INFLIGH_FRAMES ahead
+		if (forge->timeline_next_signal <= FORGE_SWAPCHIAN_INFLIGH_FRAMES)
+			return;
+
+		uint64_t wait_value = forge->timeline_next_signal - FORGE_SWAPCHIAN_INFLIGH_FRAMES;
+
+		VkSemaphoreWaitInfo wait_info{};
+		wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		wait_info.semaphoreCount = 1;
+		wait_info.pSemaphores = &forge->timeline;
+		wait_info.pValues = &wait_value;
+		auto res = vkWaitSemaphores(forge->device, &wait_info, UINT64_MAX);
+		VK_RES_CHECK(res);
+	}
+
 	static void
 	_forge_frames_process(Forge* forge)
 	{
 		VkResult res;
 
-		auto swapchain = forge->swapchain_frame->swapchain;
-		auto index = swapchain->frame_index % FORGE_SWAPCHIAN_INFLIGH_FRAMES;
+		// Headless forges (or forges that didn't create a swapchain frame) only submit offscreen frames
+		auto swapchain = forge->swapchain_frame ? forge->swapchain_frame->swapchain : nullptr;
+		auto index = swapchain ? swapchain->frame_index % FORGE_SWAPCHIAN_INFLIGH_FRAMES : 0u;
 
-		VkCommandBuffer command_buffers[FORGE_MAX_OFF_SCREEN_FRAMES];
+		VkCommandBuffer command_buffers[FORGE_MAX_OFF_SCREEN_FRAMES + 1];
 		uint32_t command_buffers_count = 0u;
 		for (uint32_t i = 0; i < FORGE_MAX_OFF_SCREEN_FRAMES; ++i)
 		{
@@ -534,7 +721,11 @@ namespace forge
 
 			++command_buffers_count;
 		}
-		command_buffers[command_buffers_count++] = forge->swapchain_frame->command_buffer;
+
+		if (swapchain)
+		{
+			command_buffers[command_buffers_count++] = forge->swapchain_frame->command_buffer;
+		}
 
 		constexpr uint32_t MAX_SIGNAL_SEMAPHORES = 4u;
 		VkSemaphore signal_semaphores[MAX_SIGNAL_SEMAPHORES]{};
@@ -544,8 +735,11 @@ namespace forge
 		signal_semaphores[signal_semaphores_count] = forge->timeline;
 		signal_values[signal_semaphores_count++] = forge->timeline_next_signal;
 
-		signal_semaphores[signal_semaphores_count] = swapchain->rendering_done[index];
-		signal_values[signal_semaphores_count++] = UINT64_MAX;
+		if (swapchain)
+		{
+			signal_semaphores[signal_semaphores_count] = swapchain->rendering_done[index];
+			signal_values[signal_semaphores_count++] = UINT64_MAX;
+		}
 
 		constexpr uint32_t MAX_WAIT_SEMAPHORES = 4u;
 		VkSemaphore wait_semaphores[MAX_WAIT_SEMAPHORES]{};
@@ -553,9 +747,20 @@ namespace forge
 		VkPipelineStageFlags wait_stages[MAX_WAIT_SEMAPHORES] = {};
 		uint32_t wait_semaphores_count = 0;
 
-		wait_semaphores[wait_semaphores_count] = swapchain->image_available[index];
-		wait_values[wait_semaphores_count] = UINT64_MAX;
-		wait_stages[wait_semaphores_count++] = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		if (swapchain)
+		{
+			wait_semaphores[wait_semaphores_count] = swapchain->image_available[index];
+			wait_values[wait_semaphores_count] = UINT64_MAX;
+			wait_stages[wait_semaphores_count++] = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		}
+
+		// Frames consume whatever was uploaded before they were flushed
+		if (forge->staging->timeline_submitted_signal > 0u)
+		{
+			wait_semaphores[wait_semaphores_count] = forge->staging->timeline;
+			wait_values[wait_semaphores_count] = forge->staging->timeline_submitted_signal;
+			wait_stages[wait_semaphores_count++] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		}
 
 		VkTimelineSemaphoreSubmitInfo timeline_info {};
 		timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
@@ -564,7 +769,7 @@ namespace forge
 		timeline_info.signalSemaphoreValueCount = signal_semaphores_count;
 		timeline_info.pSignalSemaphoreValues = signal_values;
 
-		VkFence signal_fence = swapchain->fence[index];
+		VkFence signal_fence = swapchain ? swapchain->fence[index] : VK_NULL_HANDLE;
 
 		VkSubmitInfo submit_info {};
 		submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -579,24 +784,46 @@ namespace forge
 		res = vkQueueSubmit(forge->queue, 1u, &submit_info, signal_fence);
 		VK_RES_CHECK(res);
 
-		VkPresentInfoKHR present_info {};
-		present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-		present_info.waitSemaphoreCount = 1u;
-		present_info.pWaitSemaphores = &swapchain->rendering_done[index];
-		present_info.swapchainCount = 1u;
-		present_info.pSwapchains = &swapchain->handle;
-		present_info.pImageIndices = &swapchain->image_index;
-		res = vkQueuePresentKHR(forge->queue, &present_info);
-		VK_RES_CHECK(res);
+		if (swapchain)
+		{
+			VkPresentInfoKHR present_info {};
+			present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+			present_info.waitSemaphoreCount = 1u;
+			present_info.pWaitSemaphores = &swapchain->rendering_done[index];
+			present_info.swapchainCount = 1u;
+			present_info.pSwapchains = &swapchain->handle;
+			present_info.pImageIndices = &swapchain->image_index;
+			res = vkQueuePresentKHR(forge->queue, &present_info);
+			VK_RES_CHECK(res);
+
+			++swapchain->frame_index;
+		}
 
 		++forge->timeline_next_signal;
-		++swapchain->frame_index;
+
+		if (swapchain == nullptr)
+		{
+			_forge_frames_throttle(forge);
+		}
 	}
 
 	Forge*
 	forge_new()
+	{
+		return forge_new(ForgeDescription{});
+	}
+
+	Forge*
+	forge_new(ForgeDescription description)
 	{
 		auto forge = new Forge();
+		forge->description = description;
+
+		if (forge->description.headless)
+		{
+			log_info("Forge is running in headless mode, only offscreen frames can be created");
+		}
+
 		if (_forge_init(forge) == false)
 		{
 			forge_destroy(forge);
@@ -619,6 +846,7 @@ namespace forge
 	void
 	forge_flush(Forge* forge)
 	{
+		forge_staging_submit(forge, forge->staging);
 		_forge_frames_process(forge);
 		forge_deletion_queue_flush(forge, forge->deletion_queue, false);
 	}
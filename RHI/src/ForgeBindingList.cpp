@@ -39,7 +39,7 @@ namespace forge
 		}
 
 		auto& attribute_layout = shader->description.attributes[binding];
-		if (attribute_layout.name.empty() == true)
+		if (attribute_layout.format == VK_FORMAT_UNDEFINED)
 		{
 			log_error("The provided binding '{}' doesn't map to a valid binding in the shader '{}'", binding, shader->description.name);
 			return false;
@@ -58,8 +58,14 @@ namespace forge
 	}
 
 	bool
-	forge_binding_list_index_buffer_bind(Forge* forge, ForgeBindingList* list, ForgeShader* shader, ForgeBuffer* buffer)
+	forge_binding_list_index_buffer_bind(Forge* forge, ForgeBindingList* list, ForgeShader* shader, ForgeBuffer* buffer, VkIndexType index_type)
 	{
+		if (index_type != VK_INDEX_TYPE_UINT16 && index_type != VK_INDEX_TYPE_UINT32)
+		{
+			log_error("The provided index type '{}' is not supported, only 16 and 32 bits indices are", (uint32_t)index_type);
+			return false;
+		}
+
 		auto& usage = buffer->description.usage;
 		if ((usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) == 0)
 		{
@@ -68,6 +74,7 @@ namespace forge
 		}
 
 		list->index_buffer = buffer;
+		list->index_type = index_type;
 
 		return true;
 	}
@@ -103,4 +110,57 @@ namespace forge
 
 		return true;
 	}
+
+	bool
+	forge_binding_list_sampler_bind(Forge* forge, ForgeBindingList* list, ForgeShader* shader, uint32_t binding, ForgeSampler* sampler)
+	{
+		if (binding >= FORGE_MAX_IMAGE_BINDINGS)
+		{
+			log_error("The provided binding '{}' doesn't map to a valid binding in the shader '{}'", binding, shader->description.name);
+			return false;
+		}
+
+		if (shader->description.images[binding].storage == true)
+		{
+			log_error("The binding '{}' of the shader '{}' is a storage image which can't be sampled", binding, shader->description.name);
+			return false;
+		}
+
+		list->samplers[binding] = sampler;
+
+		return true;
+	}
+
+	bool
+	forge_binding_list_storage_buffer_bind(Forge* forge, ForgeBindingList* list, ForgeShader* shader, uint32_t binding, ForgeBuffer* buffer)
+	{
+		if (binding >= FORGE_MAX_STORAGE_BUFFER_BINDINGS)
+		{
+			log_error("The provided binding '{}' exceeds the binding limit of storage buffers '{}'", binding, FORGE_MAX_STORAGE_BUFFER_BINDINGS);
+			return false;
+		}
+
+		auto& buffer_layout = shader->description.storage_buffers[binding];
+		if (buffer_layout.stages == 0u)
+		{
+			log_error("The provided binding '{}' doesn't map to a valid binding in the shader '{}'", binding, shader->description.name);
+			return false;
+		}
+
+		if ((buffer->description.usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) == 0)
+		{
+			log_error("The provided buffer '{}' is not a storage buffer", buffer->description.name);
+			return false;
+		}
+
+		if (buffer->description.size < buffer_layout.size)
+		{
+			log_error("The provided buffer '{}' size '{}' is smaller than the storage block's size '{}'", buffer->description.name, buffer->description.size, buffer_layout.size);
+			return false;
+		}
+
+		list->storage_buffers[binding] = buffer;
+
+		return true;
+	}
 };
\ No newline at end of file
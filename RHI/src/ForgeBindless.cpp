@@ -0,0 +1,194 @@
+#include "Forge.h"
+#include "ForgeBindless.h"
+#include "ForgeImage.h"
+#include "ForgeSampler.h"
+#include "ForgeLogger.h"
+#include "ForgeUtils.h"
+#include "ForgeDeletionQueue.h"
+
+#include <algorithm>
+
+namespace forge
+{
+	static bool
+	_forge_bindless_table_init(Forge* forge, ForgeBindlessTable* table)
+	{
+		VkResult res;
+
+		VkPhysicalDeviceVulkan12Properties properties_12 {};
+		properties_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+		VkPhysicalDeviceProperties2 properties {};
+		properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties.pNext = &properties_12;
+		vkGetPhysicalDeviceProperties2(forge->physical_device, &properties);
+
+		table->capacity = std::min({
+			FORGE_BINDLESS_MAX_IMAGES,
+			properties_12.maxDescriptorSetUpdateAfterBindSampledImages,
+			properties_12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+			properties_12.maxPerStageDescriptorUpdateAfterBindSamplers
+		});
+
+		VkDescriptorBindingFlags binding_flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info {};
+		binding_flags_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		binding_flags_info.bindingCount = 1u;
+		binding_flags_info.pBindingFlags = &binding_flags;
+
+		VkDescriptorSetLayoutBinding binding {};
+		binding.binding = 0u;
+		binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		binding.descriptorCount = table->capacity;
+		binding.stageFlags = VK_SHADER_STAGE_ALL;
+
+		VkDescriptorSetLayoutCreateInfo layout_info {};
+		layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layout_info.pNext = &binding_flags_info;
+		layout_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+		layout_info.bindingCount = 1u;
+		layout_info.pBindings = &binding;
+		res = vkCreateDescriptorSetLayout(forge->device, &layout_info, nullptr, &table->layout);
+		VK_RES_CHECK(res);
+
+		if (res != VK_SUCCESS)
+		{
+			log_error("Failed to create the bindless descriptor set layout, the following error code '{}' is reported", _forge_result_to_str(res));
+			return false;
+		}
+
+		VkDescriptorPoolSize pool_size {};
+		pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		pool_size.descriptorCount = table->capacity;
+
+		VkDescriptorPoolCreateInfo pool_info {};
+		pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+		pool_info.maxSets = 1u;
+		pool_info.poolSizeCount = 1u;
+		pool_info.pPoolSizes = &pool_size;
+		res = vkCreateDescriptorPool(forge->device, &pool_info, nullptr, &table->pool);
+		VK_RES_CHECK(res);
+
+		if (res != VK_SUCCESS)
+		{
+			log_error("Failed to create the bindless descriptor pool, the following error code '{}' is reported", _forge_result_to_str(res));
+			return false;
+		}
+
+		VkDescriptorSetAllocateInfo allocate_info {};
+		allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocate_info.descriptorPool = table->pool;
+		allocate_info.descriptorSetCount = 1u;
+		allocate_info.pSetLayouts = &table->layout;
+		res = vkAllocateDescriptorSets(forge->device, &allocate_info, &table->set);
+		VK_RES_CHECK(res);
+
+		if (res != VK_SUCCESS)
+		{
+			log_error("Failed to allocate the bindless descriptor set, the following error code '{}' is reported", _forge_result_to_str(res));
+			return false;
+		}
+
+		_forge_debug_obj_name_set(forge, (uint64_t)table->set, VK_OBJECT_TYPE_DESCRIPTOR_SET, "Forge bindless table");
+
+		table->next_index = 0u;
+
+		log_info("A bindless table with '{}' image slots was created successfully", table->capacity);
+
+		return true;
+	}
+
+	static void
+	_forge_bindless_table_free(Forge* forge, ForgeBindlessTable* table)
+	{
+		// Destroyed after the deletion queue is flushed since pending removals still point at the table
+		if (table->pool)
+		{
+			vkDestroyDescriptorPool(forge->device, table->pool, nullptr);
+		}
+
+		if (table->layout)
+		{
+			vkDestroyDescriptorSetLayout(forge->device, table->layout, nullptr);
+		}
+	}
+
+	ForgeBindlessTable*
+	forge_bindless_table_new(Forge* forge)
+	{
+		auto table = new ForgeBindlessTable();
+
+		if (_forge_bindless_table_init(forge, table) == false)
+		{
+			forge_bindless_table_destroy(forge, table);
+			return nullptr;
+		}
+
+		return table;
+	}
+
+	uint32_t
+	forge_bindless_table_image_add(Forge* forge, ForgeBindlessTable* table, ForgeImage* image)
+	{
+		std::lock_guard<std::mutex> lock(table->mutex);
+
+		uint32_t index = FORGE_BINDLESS_INVALID_INDEX;
+		if (table->free_indices.empty() == false)
+		{
+			index = table->free_indices.back();
+			table->free_indices.pop_back();
+		}
+		else if (table->next_index < table->capacity)
+		{
+			index = table->next_index++;
+		}
+		else
+		{
+			log_warning("The bindless table is full ('{}' images), '{}' can only be bound through binding lists", table->capacity, image->description.name);
+			return FORGE_BINDLESS_INVALID_INDEX;
+		}
+
+		VkDescriptorImageInfo image_info {};
+		image_info.sampler = image->sampler->handle;
+		image_info.imageView = image->shader_view;
+		image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		VkWriteDescriptorSet write_info {};
+		write_info.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write_info.dstSet = table->set;
+		write_info.dstBinding = 0u;
+		write_info.dstArrayElement = index;
+		write_info.descriptorCount = 1u;
+		write_info.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		write_info.pImageInfo = &image_info;
+
+		// Update after bind, the set can be written while frames that don't use this slot are in flight
+		vkUpdateDescriptorSets(forge->device, 1u, &write_info, 0u, nullptr);
+
+		return index;
+	}
+
+	void
+	forge_bindless_table_image_remove(Forge* forge, ForgeBindlessTable* table, uint32_t index)
+	{
+		if (index == FORGE_BINDLESS_INVALID_INDEX)
+			return;
+
+		forge_deletion_queue_push_callback(forge, forge->deletion_queue, [table, index]() {
+			std::lock_guard<std::mutex> lock(table->mutex);
+			table->free_indices.push_back(index);
+		});
+	}
+
+	void
+	forge_bindless_table_destroy(Forge* forge, ForgeBindlessTable* table)
+	{
+		if (table)
+		{
+			_forge_bindless_table_free(forge, table);
+			delete table;
+		}
+	}
+};
\ No newline at end of file
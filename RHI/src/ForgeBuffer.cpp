@@ -2,6 +2,8 @@
 #include "ForgeBuffer.h"
 #include "ForgeUtils.h"
 #include "ForgeDeletionQueue.h"
+#include "ForgeMemoryAllocator.h"
+#include "ForgeStaging.h"
 
 namespace forge
 {
@@ -38,26 +40,18 @@ namespace forge
 		VkMemoryRequirements mem_requirements;
 		vkGetBufferMemoryRequirements(forge->device, buffer->handle, &mem_requirements);
 
-		VkMemoryAllocateInfo alloc_info{};
-		alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		alloc_info.allocationSize = mem_requirements.size;
-		alloc_info.memoryTypeIndex = _find_memory_type(forge, mem_requirements.memoryTypeBits, buffer->description.memory_properties);
-		res = vkAllocateMemory(forge->device, &alloc_info, nullptr, &buffer->memory);
-		VK_RES_CHECK(res);
-
-		if (res != VK_SUCCESS)
+		if (forge_memory_allocator_allocate(forge, forge->memory_allocator, mem_requirements, buffer->description.memory_properties, FORGE_MEMORY_RESOURCE_LINEAR, &buffer->memory) == false)
 		{
-			log_error("Failed to allocate memory for the buffer '{}', the following error code '{}' is reported", buffer->description.name, _forge_result_to_str(res));
+			log_error("Failed to allocate memory for the buffer '{}'", buffer->description.name);
 			return false;
 		}
 
-		res = vkBindBufferMemory(forge->device, buffer->handle, buffer->memory, 0);
+		res = vkBindBufferMemory(forge->device, buffer->handle, buffer->memory.memory, buffer->memory.offset);
 		VK_RES_CHECK(res);
 
 		if (buffer->description.memory_properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
 		{
-			res = vkMapMemory(forge->device, buffer->memory, 0u, mem_requirements.size, 0u, &buffer->mapped_ptr);
-			VK_RES_CHECK(res);
+			buffer->mapped_ptr = buffer->memory.mapped_ptr;
 		}
 
 		buffer->description.size = mem_requirements.size;
@@ -68,8 +62,6 @@ namespace forge
 	static void
 	_forge_buffer_write(Forge* forge, ForgeBuffer* buffer, void* data, uint32_t size)
 	{
-		VkResult res;
-
 		if (buffer->description.memory_properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
 		{
 			memcpy(buffer->mapped_ptr, data, size);
@@ -78,71 +70,45 @@ namespace forge
 			{
 				VkMappedMemoryRange range{};
 				range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-				range.memory = buffer->memory;
-				range.offset = 0u;
-				range.size = std::min(_forge_align_up(size, forge->physical_device_limits.nonCoherentAtomSize), (uint64_t)buffer->description.size);
+				range.memory = buffer->memory.memory;
+				range.offset = buffer->memory.offset;
+				range.size = std::min(_forge_align_up(size, forge->physical_device_limits.nonCoherentAtomSize), buffer->memory.size);
 				auto res = vkFlushMappedMemoryRanges(forge->device, 1u, &range);
 				VK_RES_CHECK(res);
 			}
 		}
 		else
 		{
-			auto staging_buffer = forge->staging_buffer;
+			auto staging = forge->staging;
 			char* source_data = (char*)data;
 			uint32_t remaining_size = size;
 			uint32_t count = 0u;
 
-			VkCommandBufferBeginInfo begin_info{};
-			begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-			begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-			res = vkBeginCommandBuffer(forge->staging_command_buffer, &begin_info);
-			VK_RES_CHECK(res);
-
 			while (remaining_size > 0)
 			{
-				uint32_t chunk_size = std::min(remaining_size, staging_buffer->description.size);
-
-				if (staging_buffer->cursor + chunk_size > staging_buffer->description.size)
-				{
-					staging_buffer->cursor = 0;
-
-					vkEndCommandBuffer(forge->staging_command_buffer);
-
-					// Submit pending transfer operations
-					VkSubmitInfo submit_info{};
-					submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-					submit_info.commandBufferCount = 1;
-					submit_info.pCommandBuffers = &forge->staging_command_buffer;
-					res = vkQueueSubmit(forge->queue, 1u, &submit_info, VK_NULL_HANDLE);
-					VK_RES_CHECK(res);
+				uint32_t chunk_size = std::min(remaining_size, staging->region_size);
 
-					// Wait for the queue to ensure all transfers are complete
-					// TODO: We shouldn't halt the whole queue for this
-					vkQueueWaitIdle(forge->queue);
+				uint32_t staging_offset = 0u;
+				auto command_buffer = forge_staging_reserve(forge, staging, chunk_size, 4u, &staging_offset);
 
-					res = vkBeginCommandBuffer(forge->staging_command_buffer, &begin_info);
-					VK_RES_CHECK(res);
-				}
-
-				memcpy((char*)staging_buffer->mapped_ptr + staging_buffer->cursor, source_data, chunk_size);
+				memcpy((char*)staging->buffer->mapped_ptr + staging_offset, source_data, chunk_size);
 
 				VkBufferCopy copy_region{};
-				copy_region.srcOffset = staging_buffer->cursor;
+				copy_region.srcOffset = staging_offset;
 				copy_region.dstOffset = size - remaining_size;
 				copy_region.size = chunk_size;
-				vkCmdCopyBuffer(forge->staging_command_buffer, staging_buffer->handle, buffer->handle, 1, &copy_region);
+				vkCmdCopyBuffer(command_buffer, staging->buffer->handle, buffer->handle, 1, &copy_region);
 
-				staging_buffer->cursor += chunk_size;
 				source_data += chunk_size;
 				remaining_size -= chunk_size;
 
 				++count;
 			}
 
-			log_info("Writing operation to '{}' was done using '{}' copy operations (Staging buffer size: {}, Total data size: {})",
-				buffer->description.name, count, staging_buffer->description.size, size);
+			buffer->upload_signal = staging->timeline_next_signal;
 
-			vkEndCommandBuffer(forge->staging_command_buffer);
+			log_info("Writing operation to '{}' was done using '{}' copy operations (Staging region size: {}, Total data size: {})",
+				buffer->description.name, count, staging->region_size, size);
 		}
 	}
 
@@ -154,9 +120,9 @@ namespace forge
 			forge_deletion_queue_push(forge, forge->deletion_queue, buffer->handle);
 		}
 
-		if (buffer->memory)
+		if (buffer->memory.memory)
 		{
-			forge_deletion_queue_push(forge, forge->deletion_queue, buffer->memory);
+			forge_memory_allocator_free(forge, forge->memory_allocator, buffer->memory);
 		}
 	}
 
@@ -185,6 +151,34 @@ namespace forge
 		_forge_buffer_write(forge, buffer, data, size);
 	}
 
+	void
+	forge_buffer_barrier(Forge* forge, VkCommandBuffer command_buffer, VkPipelineStageFlags stage, VkAccessFlags access, ForgeBuffer* buffer)
+	{
+		constexpr VkAccessFlags WRITE_ACCESS = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+		bool hazard = (buffer->access & WRITE_ACCESS) || ((access & WRITE_ACCESS) && buffer->access != 0u);
+		if (hazard == false)
+		{
+			buffer->stage |= stage;
+			buffer->access |= access;
+			return;
+		}
+
+		VkBufferMemoryBarrier barrier {};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask = buffer->access;
+		barrier.dstAccessMask = access;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer = buffer->handle;
+		barrier.offset = 0u;
+		barrier.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier(command_buffer, buffer->stage, stage, 0u, 0u, nullptr, 1u, &barrier, 0u, nullptr);
+
+		buffer->stage = stage;
+		buffer->access = access;
+	}
+
 	void
 	forge_buffer_destroy(Forge* forge, ForgeBuffer* buffer)
 	{
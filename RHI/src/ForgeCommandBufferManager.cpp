@@ -1,6 +1,7 @@
 #include "Forge.h"
 #include "ForgeCommandBufferManager.h"
 #include "ForgeLogger.h"
+#include "ForgeUtils.h"
 #include "ForgeDeletionQueue.h"
 
 #include <algorithm>
@@ -8,84 +9,229 @@
 namespace forge
 {
 	static void
-	_forge_command_buffer_begin(ForgeCommandBuffer command_buffer)
+	_forge_command_buffer_begin(VkCommandBuffer command_buffer)
 	{
 		VkCommandBufferBeginInfo begin_info {};
 		begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 		begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-		auto res = vkBeginCommandBuffer(command_buffer.handle, &begin_info);
+		auto res = vkBeginCommandBuffer(command_buffer, &begin_info);
 		VK_RES_CHECK(res);
 	}
 
-	static bool
-	_forge_command_buffer_manager_init(Forge* forge, ForgeCommandBufferManager* manager)
+	static ForgeCommandPool*
+	_forge_command_pool_new(Forge* forge, ForgeCommandPoolSet* set)
 	{
+		ForgeCommandPool pool {};
+
 		VkCommandPoolCreateInfo info{};
 		info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 		info.queueFamilyIndex = forge->queue_family_index;
-		info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-		auto res = vkCreateCommandPool(forge->device, &info, nullptr, &manager->pool);
+		info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		auto res = vkCreateCommandPool(forge->device, &info, nullptr, &pool.handle);
 		VK_RES_CHECK(res);
 
 		if (res != VK_SUCCESS)
 		{
-			log_error("Failed to create the global command pool");
-			return false;
+			log_error("Failed to create a command pool, the following error code '{}' is reported", _forge_result_to_str(res));
+			return nullptr;
+		}
+
+		set->pools.push_back(std::move(pool));
+
+		return &set->pools.back();
+	}
+
+	static ForgeCommandPool*
+	_forge_command_pool_set_acquire(Forge* forge, ForgeCommandPoolSet* set)
+	{
+		if (set->pools.empty() == false)
+		{
+			auto& current = set->pools[set->current];
+			if (current.release_signal == forge->timeline_next_signal)
+			{
+				return &current;
+			}
+		}
+
+		uint64_t value;
+		auto res = vkGetSemaphoreCounterValue(forge->device, forge->timeline, &value);
+		VK_RES_CHECK(res);
+
+		// The current pool belongs to an already flushed frame, move to a pool the GPU is done with and reset it as a whole
+		for (uint32_t i = 0; i < set->pools.size(); ++i)
+		{
+			auto& pool = set->pools[i];
+			if (value < pool.release_signal)
+				continue;
+
+			res = vkResetCommandPool(forge->device, pool.handle, 0u);
+			VK_RES_CHECK(res);
+
+			pool.used = 0u;
+			pool.secondary_used = 0u;
+			pool.release_signal = forge->timeline_next_signal;
+			set->current = i;
+
+			return &pool;
+		}
+
+		auto pool = _forge_command_pool_new(forge, set);
+		if (pool == nullptr)
+		{
+			return nullptr;
+		}
+
+		pool->release_signal = forge->timeline_next_signal;
+		set->current = (uint32_t)set->pools.size() - 1u;
+
+		return pool;
+	}
+
+	static VkCommandBuffer
+	_forge_command_pool_next(Forge* forge, ForgeCommandPool* pool, VkCommandBufferLevel level, std::vector<VkCommandBuffer>& command_buffers, uint32_t& used)
+	{
+		if (used == command_buffers.size())
+		{
+			VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+
+			VkCommandBufferAllocateInfo alloc_info{};
+			alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			alloc_info.commandBufferCount = 1u;
+			alloc_info.commandPool = pool->handle;
+			alloc_info.level = level;
+			auto res = vkAllocateCommandBuffers(forge->device, &alloc_info, &command_buffer);
+			VK_RES_CHECK(res);
+
+			if (res != VK_SUCCESS)
+			{
+				log_error("Failed to allocate a command buffer, the following error code '{}' is reported", _forge_result_to_str(res));
+				return VK_NULL_HANDLE;
+			}
+
+			command_buffers.push_back(command_buffer);
+		}
+
+		return command_buffers[used++];
+	}
+
+	static ForgeCommandPoolSet*
+	_forge_command_buffer_manager_thread_set(ForgeCommandBufferManager* manager)
+	{
+		std::lock_guard<std::mutex> lock(manager->mutex);
+
+		auto& set = manager->pool_sets[std::this_thread::get_id()];
+		if (set == nullptr)
+		{
+			set = new ForgeCommandPoolSet();
+		}
+
+		return set;
+	}
+
+	static void
+	_forge_command_pool_set_free(Forge* forge, ForgeCommandPoolSet* set)
+	{
+		// Destroying a pool frees its command buffers
+		for (auto& pool : set->pools)
+		{
+			forge_deletion_queue_push(forge, forge->deletion_queue, pool.handle);
 		}
 
+		delete set;
+	}
+
+	static bool
+	_forge_command_buffer_manager_init(Forge* forge, ForgeCommandBufferManager* manager)
+	{
 		return true;
 	}
 
 	static void
 	_forge_command_buffer_manager_free(Forge* forge, ForgeCommandBufferManager* manager)
 	{
-		if (manager->pool)
+		for (auto& [thread_id, set] : manager->pool_sets)
 		{
-			forge_deletion_queue_push(forge, forge->deletion_queue, manager->pool);
+			_forge_command_pool_set_free(forge, set);
 		}
+
+		manager->pool_sets.clear();
 	}
 
 	VkCommandBuffer
 	forge_command_buffer_acquire(Forge* forge, ForgeCommandBufferManager* manager, bool begin)
 	{
-		uint64_t value;
-		auto res = vkGetSemaphoreCounterValue(forge->device, forge->timeline, &value);
-		VK_RES_CHECK(res);
+		auto set = _forge_command_buffer_manager_thread_set(manager);
 
-		for (auto& command_buffer : manager->allocated_cb)
+		auto pool = _forge_command_pool_set_acquire(forge, set);
+		if (pool == nullptr)
 		{
-			if (value >= command_buffer.release_signal)
-			{
-				if (begin)
-				{
-					_forge_command_buffer_begin(command_buffer);
-				}
-				command_buffer.release_signal = forge->timeline_next_signal;
-
-				return command_buffer.handle;
-			}
+			return VK_NULL_HANDLE;
 		}
 
-		ForgeCommandBuffer command_buffer {};
-		command_buffer.release_signal = forge->timeline_next_signal;
-		command_buffer.pool = manager->pool;
-
-		VkCommandBufferAllocateInfo alloc_info{};
-		alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		alloc_info.commandBufferCount = 1u;
-		alloc_info.commandPool = manager->pool;
-		alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		res = vkAllocateCommandBuffers(forge->device, &alloc_info, &command_buffer.handle);
-		VK_RES_CHECK(res);
+		auto command_buffer = _forge_command_pool_next(forge, pool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, pool->command_buffers, pool->used);
+		if (command_buffer == VK_NULL_HANDLE)
+		{
+			return VK_NULL_HANDLE;
+		}
 
 		if (begin)
 		{
 			_forge_command_buffer_begin(command_buffer);
 		}
 
-		manager->allocated_cb.push_back(command_buffer);
+		return command_buffer;
+	}
+
+	VkCommandBuffer
+	forge_command_buffer_acquire_secondary(Forge* forge, ForgeCommandBufferManager* manager, VkRenderPass pass, VkFramebuffer framebuffer)
+	{
+		auto set = _forge_command_buffer_manager_thread_set(manager);
+
+		auto pool = _forge_command_pool_set_acquire(forge, set);
+		if (pool == nullptr)
+		{
+			return VK_NULL_HANDLE;
+		}
+
+		auto command_buffer = _forge_command_pool_next(forge, pool, VK_COMMAND_BUFFER_LEVEL_SECONDARY, pool->secondary_command_buffers, pool->secondary_used);
+		if (command_buffer == VK_NULL_HANDLE)
+		{
+			return VK_NULL_HANDLE;
+		}
+
+		VkCommandBufferInheritanceInfo inheritance_info {};
+		inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritance_info.renderPass = pass;
+		inheritance_info.subpass = 0u;
+		inheritance_info.framebuffer = framebuffer;
+
+		VkCommandBufferBeginInfo begin_info {};
+		begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+		begin_info.pInheritanceInfo = &inheritance_info;
+		auto res = vkBeginCommandBuffer(command_buffer, &begin_info);
+		VK_RES_CHECK(res);
+
+		return command_buffer;
+	}
+
+	void
+	forge_command_buffer_manager_thread_release(Forge* forge, ForgeCommandBufferManager* manager)
+	{
+		ForgeCommandPoolSet* set = nullptr;
+
+		{
+			std::lock_guard<std::mutex> lock(manager->mutex);
+
+			auto iter = manager->pool_sets.find(std::this_thread::get_id());
+			if (iter == manager->pool_sets.end())
+				return;
+
+			set = iter->second;
+			manager->pool_sets.erase(iter);
+		}
 
-		return command_buffer.handle;
+		_forge_command_pool_set_free(forge, set);
 	}
 
 	ForgeCommandBufferManager*
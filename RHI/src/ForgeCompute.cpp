@@ -0,0 +1,183 @@
+#include "Forge.h"
+#include "ForgeCompute.h"
+#include "ForgeFrame.h"
+#include "ForgeShader.h"
+#include "ForgeBuffer.h"
+#include "ForgeImage.h"
+#include "ForgeBindingList.h"
+#include "ForgeLogger.h"
+#include "ForgeUtils.h"
+#include "ForgeDescriptorSetManager.h"
+#include "ForgeDynamicMemory.h"
+#include "ForgeBindless.h"
+
+namespace forge
+{
+	static void
+	_forge_compute_storage_image_barrier(VkCommandBuffer command_buffer, ForgeImage* image)
+	{
+		// Layout transitions are skipped for images already in VK_IMAGE_LAYOUT_GENERAL, back to back dispatches on the
+		// same storage image still need their writes ordered
+		VkImageMemoryBarrier barrier {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image->handle;
+		barrier.subresourceRange.aspectMask = image->aspect;
+		barrier.subresourceRange.baseMipLevel = 0u;
+		barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+		barrier.subresourceRange.baseArrayLayer = 0u;
+		barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+		vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0u, 0u, nullptr, 0u, nullptr, 1u, &barrier);
+	}
+
+	static bool
+	_forge_compute_bind(Forge* forge, ForgeFrame* frame, ForgeShader* shader, ForgeBindingList* binding_list)
+	{
+		auto command_buffer = frame->command_buffer;
+
+		if (shader->modules[FORGE_SHADER_STAGE_COMPUTE] == VK_NULL_HANDLE)
+		{
+			log_error("The shader '{}' is not a compute shader", shader->description.name);
+			return false;
+		}
+
+		auto& images = shader->description.images;
+		for (uint32_t i = 0; i < FORGE_MAX_IMAGE_BINDINGS; ++i)
+		{
+			if (images[i].stages == 0u)
+				continue;
+
+			auto image = binding_list->images[i];
+			if (image == nullptr)
+			{
+				log_error("The image binding '{}' of the shader '{}' is not bound", i, shader->description.name);
+				return false;
+			}
+
+			if (images[i].storage && image->layout == VK_IMAGE_LAYOUT_GENERAL)
+			{
+				_forge_compute_storage_image_barrier(command_buffer, image);
+			}
+			else
+			{
+				forge_image_layout_transition(forge, command_buffer, images[i].storage ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, image);
+			}
+		}
+
+		auto& storage_buffers = shader->description.storage_buffers;
+		for (uint32_t i = 0; i < FORGE_MAX_STORAGE_BUFFER_BINDINGS; ++i)
+		{
+			if (storage_buffers[i].stages == 0u)
+				continue;
+
+			auto buffer = binding_list->storage_buffers[i];
+			if (buffer == nullptr)
+			{
+				log_error("The storage buffer binding '{}' of the shader '{}' is not bound", i, shader->description.name);
+				return false;
+			}
+
+			auto access = storage_buffers[i].readonly ? VK_ACCESS_SHADER_READ_BIT : VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			forge_buffer_barrier(forge, command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, access, buffer);
+		}
+
+		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, shader->pipeline);
+
+		auto& uniforms = shader->description.uniforms;
+		for (uint32_t set_index = 0; set_index < shader->sets_count; ++set_index)
+		{
+			if (shader->set_bindings[set_index].empty())
+				continue;
+
+			if (shader->push_descriptors && set_index == FORGE_SHADER_SET_DRAW)
+			{
+				if (forge_descriptor_set_push(forge, command_buffer, shader, set_index, binding_list) == false)
+				{
+					return false;
+				}
+				continue;
+			}
+
+			auto set = forge_descriptor_set_acquire(forge, forge->descriptor_set_manager, shader, set_index, binding_list);
+			if (set == VK_NULL_HANDLE)
+			{
+				return false;
+			}
+
+			// Dynamic offsets are consumed in binding order within the set
+			uint32_t uniform_offsets[FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS] {};
+			uint32_t uniform_offsets_count = 0u;
+			for (uint32_t i = 0; i < FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS; ++i)
+			{
+				auto uniform = binding_list->uniforms[i];
+				if (uniforms[i].stages == 0u || uniforms[i].set != set_index)
+					continue;
+
+				uint32_t uniform_offset = 0u;
+				if (uniform.first != 0)
+				{
+					uniform_offset = forge_dynamic_memory_write(forge, forge->uniform_memory, uniform.first, forge->physical_device_limits.minUniformBufferOffsetAlignment, uniform.second);
+				}
+
+				uniform_offsets[uniform_offsets_count++] = uniform_offset;
+			}
+
+			vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, shader->pipeline_layout, set_index, 1u, &set, uniform_offsets_count, uniform_offsets);
+		}
+
+		if (shader->bindless)
+		{
+			vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, shader->pipeline_layout, FORGE_BINDLESS_SET, 1u, &forge->bindless_table->set, 0u, nullptr);
+		}
+
+		return true;
+	}
+
+	bool
+	forge_compute_dispatch(Forge* forge, ForgeFrame* frame, ForgeShader* shader, ForgeBindingList* binding_list, uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z)
+	{
+		auto& limits = forge->physical_device_limits;
+		if (group_count_x > limits.maxComputeWorkGroupCount[0] ||
+			group_count_y > limits.maxComputeWorkGroupCount[1] ||
+			group_count_z > limits.maxComputeWorkGroupCount[2])
+		{
+			log_error("The dispatch '{}x{}x{}' exceeds the device's work group count limit '{}x{}x{}'",
+				group_count_x, group_count_y, group_count_z,
+				limits.maxComputeWorkGroupCount[0], limits.maxComputeWorkGroupCount[1], limits.maxComputeWorkGroupCount[2]);
+			return false;
+		}
+
+		if (_forge_compute_bind(forge, frame, shader, binding_list) == false)
+		{
+			return false;
+		}
+
+		vkCmdDispatch(frame->command_buffer, group_count_x, group_count_y, group_count_z);
+
+		return true;
+	}
+
+	bool
+	forge_compute_dispatch_indirect(Forge* forge, ForgeFrame* frame, ForgeShader* shader, ForgeBindingList* binding_list, ForgeBuffer* buffer, uint64_t offset)
+	{
+		if ((buffer->description.usage & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT) == 0)
+		{
+			log_error("The provided buffer '{}' is not an indirect buffer", buffer->description.name);
+			return false;
+		}
+
+		if (_forge_compute_bind(forge, frame, shader, binding_list) == false)
+		{
+			return false;
+		}
+
+		vkCmdDispatchIndirect(frame->command_buffer, buffer->handle, offset);
+
+		return true;
+	}
+};
\ No newline at end of file
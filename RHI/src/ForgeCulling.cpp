@@ -0,0 +1,285 @@
+#include "Forge.h"
+#include "ForgeCulling.h"
+#include "ForgeBuffer.h"
+#include "ForgeImage.h"
+#include "ForgeFrame.h"
+#include "ForgeLogger.h"
+#include "ForgeShader.h"
+#include "ForgeCompute.h"
+#include "ForgeBindingList.h"
+
+#include <cmath>
+#include <string.h>
+
+namespace forge
+{
+	static const char* CULLING_SHADER_SOURCE = R"(
+#version 450
+
+layout(local_size_x = 64) in;
+
+struct Object
+{
+	vec3 center;
+	float radius;
+	uint index_count;
+	uint first_index;
+	int vertex_offset;
+	uint instance_id;
+};
+
+struct DrawCommand
+{
+	uint index_count;
+	uint instance_count;
+	uint first_index;
+	int vertex_offset;
+	uint first_instance;
+};
+
+layout(set = 0, binding = 0) uniform Culling
+{
+	mat4 view_projection;
+	vec4 planes[6];
+	vec2 hiz_size;
+	uint objects_count;
+	uint hiz_enabled;
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Objects { Object objects[]; };
+layout(std430, set = 0, binding = 2) writeonly buffer Draws { DrawCommand draws[]; };
+layout(std430, set = 0, binding = 3) buffer Count { uint draw_count; };
+layout(set = 0, binding = 4) uniform sampler2D hiz;
+
+bool occluded(vec3 center, float radius)
+{
+	vec2 uv_min = vec2(1.0);
+	vec2 uv_max = vec2(0.0);
+	float depth_min = 1.0;
+
+	for (int i = 0; i < 8; ++i)
+	{
+		vec3 corner = center + radius * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+		vec4 clip = view_projection * vec4(corner, 1.0);
+
+		// The bounds cross the near plane, their projection can't be trusted
+		if (clip.w <= 0.0)
+			return false;
+
+		vec3 ndc = clip.xyz / clip.w;
+		uv_min = min(uv_min, ndc.xy * 0.5 + 0.5);
+		uv_max = max(uv_max, ndc.xy * 0.5 + 0.5);
+		depth_min = min(depth_min, ndc.z);
+	}
+
+	uv_min = clamp(uv_min, vec2(0.0), vec2(1.0));
+	uv_max = clamp(uv_max, vec2(0.0), vec2(1.0));
+
+	// Pick the level where the bounds cover at most 2x2 texels
+	vec2 extent = (uv_max - uv_min) * hiz_size;
+	float level = ceil(log2(max(max(extent.x, extent.y), 1.0)));
+
+	float depth = max(
+		max(textureLod(hiz, uv_min, level).r, textureLod(hiz, uv_max, level).r),
+		max(textureLod(hiz, vec2(uv_min.x, uv_max.y), level).r, textureLod(hiz, vec2(uv_max.x, uv_min.y), level).r)
+	);
+
+	return depth_min > depth;
+}
+
+void main()
+{
+	uint index = gl_GlobalInvocationID.x;
+	if (index >= objects_count)
+		return;
+
+	Object object = objects[index];
+	vec4 center = vec4(object.center, 1.0);
+
+	bool visible = true;
+	for (int i = 0; i < 6; ++i)
+	{
+		visible = visible && dot(planes[i], center) > -object.radius;
+	}
+
+	if (visible && hiz_enabled != 0u)
+	{
+		visible = occluded(object.center, object.radius) == false;
+	}
+
+	if (visible == false)
+		return;
+
+	uint slot = atomicAdd(draw_count, 1u);
+	draws[slot] = DrawCommand(object.index_count, 1u, object.first_index, object.vertex_offset, object.instance_id);
+}
+)";
+
+	// std140 layout of the Culling uniform block
+	struct ForgeCullingUniforms
+	{
+		float view_projection[16];
+		float planes[6][4];
+		float hiz_size[2];
+		uint32_t objects_count;
+		uint32_t hiz_enabled;
+	};
+
+	static void
+	_forge_culling_frustum_planes(const float* m, float planes[6][4])
+	{
+		// Gribb/Hartmann extraction from the rows of a column major matrix, clip space depth is [0, w]
+		auto row = [m](uint32_t r, uint32_t c) { return m[c * 4u + r]; };
+
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			planes[0][c] = row(3, c) + row(0, c); // Left
+			planes[1][c] = row(3, c) - row(0, c); // Right
+			planes[2][c] = row(3, c) + row(1, c); // Bottom
+			planes[3][c] = row(3, c) - row(1, c); // Top
+			planes[4][c] = row(2, c);             // Near
+			planes[5][c] = row(3, c) - row(2, c); // Far
+		}
+
+		// Normalized so the distance can be compared against the bounding sphere radius
+		for (uint32_t i = 0; i < 6; ++i)
+		{
+			auto length = std::sqrt(planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1] + planes[i][2] * planes[i][2]);
+			if (length <= 0.0f)
+				continue;
+
+			for (uint32_t c = 0; c < 4; ++c)
+			{
+				planes[i][c] /= length;
+			}
+		}
+	}
+
+	static bool
+	_forge_culling_init(Forge* forge, ForgeCulling* culling)
+	{
+		// Surviving draws carry the object id as firstInstance, which must be zero without the feature
+		if (forge->physical_device_features.drawIndirectFirstInstance == VK_FALSE)
+		{
+			log_error("Device doesn't support drawIndirectFirstInstance, GPU culling is unavailable");
+			return false;
+		}
+
+		// Compiled and reflected like any other compute shader, descriptor sets come from the descriptor set manager
+		culling->shader = forge_compute_shader_new(forge, "Forge culling", CULLING_SHADER_SOURCE);
+		if (culling->shader == nullptr)
+		{
+			log_error("Failed to create the culling shader");
+			return false;
+		}
+
+		ForgeImageDescription hiz_desc {};
+		hiz_desc.name = "Forge culling Hi-Z fallback";
+		hiz_desc.extent = {1u, 1u, 1u};
+		hiz_desc.type = VK_IMAGE_TYPE_2D;
+		hiz_desc.format = VK_FORMAT_R32_SFLOAT;
+		hiz_desc.usage = VK_IMAGE_USAGE_SAMPLED_BIT;
+		hiz_desc.memory_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		hiz_desc.mag_filter = VK_FILTER_NEAREST;
+		hiz_desc.min_filter = VK_FILTER_NEAREST;
+		hiz_desc.mipmap_mode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		culling->hiz_fallback = forge_image_new(forge, hiz_desc);
+
+		if (culling->hiz_fallback == nullptr)
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	static void
+	_forge_culling_free(Forge* forge, ForgeCulling* culling)
+	{
+		if (culling->hiz_fallback)
+		{
+			forge_image_destroy(forge, culling->hiz_fallback);
+		}
+
+		forge_shader_destroy(forge, culling->shader);
+	}
+
+	ForgeCulling*
+	forge_culling_new(Forge* forge)
+	{
+		auto culling = new ForgeCulling();
+
+		if (_forge_culling_init(forge, culling) == false)
+		{
+			forge_culling_destroy(forge, culling);
+			return nullptr;
+		}
+
+		return culling;
+	}
+
+	bool
+	forge_culling_dispatch(Forge* forge, ForgeCulling* culling, ForgeFrame* frame, ForgeCullingDescription description)
+	{
+		auto command_buffer = frame->command_buffer;
+
+		constexpr VkBufferUsageFlags OUTPUT_USAGE = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+		if ((description.objects->description.usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) == 0 ||
+			(description.draws->description.usage & OUTPUT_USAGE) != OUTPUT_USAGE ||
+			(description.count->description.usage & (OUTPUT_USAGE | VK_BUFFER_USAGE_TRANSFER_DST_BIT)) != (OUTPUT_USAGE | VK_BUFFER_USAGE_TRANSFER_DST_BIT))
+		{
+			log_error("Culling buffers are missing the required storage, indirect or transfer usages");
+			return false;
+		}
+
+		auto hiz = description.hiz ? description.hiz : culling->hiz_fallback;
+
+		ForgeCullingUniforms uniforms {};
+		memcpy(uniforms.view_projection, description.view_projection, sizeof(uniforms.view_projection));
+		_forge_culling_frustum_planes(description.view_projection, uniforms.planes);
+		uniforms.hiz_size[0] = (float)hiz->description.extent.width;
+		uniforms.hiz_size[1] = (float)hiz->description.extent.height;
+		uniforms.objects_count = description.objects_count;
+		uniforms.hiz_enabled = description.hiz ? 1u : 0u;
+
+		auto shader = culling->shader;
+
+		ForgeBindingList binding_list {};
+		bool bound = forge_binding_list_uniform_write(forge, &binding_list, shader, 0u, {sizeof(uniforms), &uniforms}) &&
+			forge_binding_list_storage_buffer_bind(forge, &binding_list, shader, 1u, description.objects) &&
+			forge_binding_list_storage_buffer_bind(forge, &binding_list, shader, 2u, description.draws) &&
+			forge_binding_list_storage_buffer_bind(forge, &binding_list, shader, 3u, description.count) &&
+			forge_binding_list_image_bind(forge, &binding_list, shader, 4u, hiz);
+
+		if (bound == false)
+		{
+			return false;
+		}
+
+		// Last frame's indirect reads of the count must be done before it's cleared, the dispatch orders the rest
+		forge_buffer_barrier(forge, command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, description.count);
+		vkCmdFillBuffer(command_buffer, description.count->handle, 0u, sizeof(uint32_t), 0u);
+
+		auto group_count = (description.objects_count + FORGE_CULLING_GROUP_SIZE - 1u) / FORGE_CULLING_GROUP_SIZE;
+		if (forge_compute_dispatch(forge, frame, shader, &binding_list, group_count, 1u, 1u) == false)
+		{
+			return false;
+		}
+
+		// The draws read the outputs inside the frame's pass, where no barrier can be recorded
+		forge_buffer_barrier(forge, command_buffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, description.draws);
+		forge_buffer_barrier(forge, command_buffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, description.count);
+
+		return true;
+	}
+
+	void
+	forge_culling_destroy(Forge* forge, ForgeCulling* culling)
+	{
+		if (culling)
+		{
+			_forge_culling_free(forge, culling);
+			delete culling;
+		}
+	}
+};
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "ForgeUtils.h"
 
 #include <algorithm>
+#include <iterator>
 
 namespace forge
 {
@@ -31,6 +32,50 @@ namespace forge
 		return queue;
 	}
 
+	void
+	forge_deletion_queue_push_callback(Forge* forge, ForgeDeletionQueue* queue, std::function<void()> callback)
+	{
+		ForgeDeletionQueue::Entry entry{};
+		entry.signal = forge->timeline_next_signal;
+		entry.type = VK_OBJECT_TYPE_UNKNOWN;
+		entry.callback = std::move(callback);
+
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		queue->entries.push_back(std::move(entry));
+	}
+
+	static void
+	_forge_deletion_queue_entry_destroy(Forge* forge, const ForgeDeletionQueue::Entry& entry)
+	{
+		switch (entry.type)
+		{
+		case VK_OBJECT_TYPE_UNKNOWN:               entry.callback(); break;
+		case VK_OBJECT_TYPE_SWAPCHAIN_KHR:         vkDestroySwapchainKHR(forge->device, (VkSwapchainKHR)entry.handle, nullptr); break;
+		case VK_OBJECT_TYPE_BUFFER:                vkDestroyBuffer(forge->device, (VkBuffer)entry.handle, nullptr); break;
+		case VK_OBJECT_TYPE_IMAGE:                 vkDestroyImage(forge->device, (VkImage)entry.handle, nullptr); break;
+		case VK_OBJECT_TYPE_IMAGE_VIEW:            vkDestroyImageView(forge->device, (VkImageView)entry.handle, nullptr); break;
+		case VK_OBJECT_TYPE_SAMPLER:               vkDestroySampler(forge->device, (VkSampler)entry.handle, nullptr); break;
+		case VK_OBJECT_TYPE_RENDER_PASS:           vkDestroyRenderPass(forge->device, (VkRenderPass)entry.handle, nullptr); break;
+		case VK_OBJECT_TYPE_FRAMEBUFFER:           vkDestroyFramebuffer(forge->device, (VkFramebuffer)entry.handle, nullptr); break;
+		case VK_OBJECT_TYPE_COMMAND_POOL:          vkDestroyCommandPool(forge->device, (VkCommandPool)entry.handle, nullptr); break;
+		case VK_OBJECT_TYPE_SHADER_MODULE:         vkDestroyShaderModule(forge->device, (VkShaderModule)entry.handle, nullptr); break;
+		case VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT: vkDestroyDescriptorSetLayout(forge->device, (VkDescriptorSetLayout)entry.handle, nullptr); break;
+		case VK_OBJECT_TYPE_DESCRIPTOR_POOL:       vkDestroyDescriptorPool(forge->device, (VkDescriptorPool)entry.handle, nullptr); break;
+		case VK_OBJECT_TYPE_DESCRIPTOR_UPDATE_TEMPLATE: vkDestroyDescriptorUpdateTemplate(forge->device, (VkDescriptorUpdateTemplate)entry.handle, nullptr); break;
+		case VK_OBJECT_TYPE_PIPELINE_LAYOUT:       vkDestroyPipelineLayout(forge->device, (VkPipelineLayout)entry.handle, nullptr); break;
+		case VK_OBJECT_TYPE_PIPELINE:              vkDestroyPipeline(forge->device, (VkPipeline)entry.handle, nullptr); break;
+		case VK_OBJECT_TYPE_SEMAPHORE:             vkDestroySemaphore(forge->device, (VkSemaphore)entry.handle, nullptr); break;
+		case VK_OBJECT_TYPE_FENCE:                 vkDestroyFence(forge->device, (VkFence)entry.handle, nullptr); break;
+		case VK_OBJECT_TYPE_DEVICE_MEMORY:         vkFreeMemory(forge->device, (VkDeviceMemory)entry.handle, nullptr); break;
+		case VK_OBJECT_TYPE_DEVICE:                vkDestroyDevice(forge->device, nullptr); break;
+		case VK_OBJECT_TYPE_INSTANCE:              vkDestroyInstance(forge->instance, nullptr); break;
+		default:
+			log_error("object type '{}' is not handled", _forge_object_type_str(entry.type));
+			assert(false);
+			break;
+		}
+	}
+
 	void
 	forge_deletion_queue_flush(Forge* forge, ForgeDeletionQueue* queue, bool immediate)
 	{
@@ -38,41 +83,24 @@ namespace forge
 		auto res = vkGetSemaphoreCounterValue(forge->device, forge->timeline, &value);
 		VK_RES_CHECK(res);
 
-		auto iter = std::remove_if(queue->entries.begin(), queue->entries.end(), [forge, immediate, queue, value](const ForgeDeletionQueue::Entry& entry) {
-			if (immediate || value >= entry.signal)
-			{
-				switch (entry.type)
-				{
-				case VK_OBJECT_TYPE_SWAPCHAIN_KHR:         vkDestroySwapchainKHR(forge->device, (VkSwapchainKHR)entry.handle, nullptr); break;
-				case VK_OBJECT_TYPE_BUFFER:                vkDestroyBuffer(forge->device, (VkBuffer)entry.handle, nullptr); break;
-				case VK_OBJECT_TYPE_IMAGE:                 vkDestroyImage(forge->device, (VkImage)entry.handle, nullptr); break;
-				case VK_OBJECT_TYPE_IMAGE_VIEW:            vkDestroyImageView(forge->device, (VkImageView)entry.handle, nullptr); break;
-				case VK_OBJECT_TYPE_SAMPLER:               vkDestroySampler(forge->device, (VkSampler)entry.handle, nullptr); break;
-				case VK_OBJECT_TYPE_RENDER_PASS:           vkDestroyRenderPass(forge->device, (VkRenderPass)entry.handle, nullptr); break;
-				case VK_OBJECT_TYPE_FRAMEBUFFER:           vkDestroyFramebuffer(forge->device, (VkFramebuffer)entry.handle, nullptr); break;
-				case VK_OBJECT_TYPE_COMMAND_POOL:          vkDestroyCommandPool(forge->device, (VkCommandPool)entry.handle, nullptr); break;
-				case VK_OBJECT_TYPE_SHADER_MODULE:         vkDestroyShaderModule(forge->device, (VkShaderModule)entry.handle, nullptr); break;
-				case VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT: vkDestroyDescriptorSetLayout(forge->device, (VkDescriptorSetLayout)entry.handle, nullptr); break;
-				case VK_OBJECT_TYPE_DESCRIPTOR_POOL:       vkDestroyDescriptorPool(forge->device, (VkDescriptorPool)entry.handle, nullptr); break;
-				case VK_OBJECT_TYPE_PIPELINE_LAYOUT:       vkDestroyPipelineLayout(forge->device, (VkPipelineLayout)entry.handle, nullptr); break;
-				case VK_OBJECT_TYPE_PIPELINE:              vkDestroyPipeline(forge->device, (VkPipeline)entry.handle, nullptr); break;
-				case VK_OBJECT_TYPE_SEMAPHORE:             vkDestroySemaphore(forge->device, (VkSemaphore)entry.handle, nullptr); break;
-				case VK_OBJECT_TYPE_FENCE:                 vkDestroyFence(forge->device, (VkFence)entry.handle, nullptr); break;
-				case VK_OBJECT_TYPE_DEVICE_MEMORY:         vkFreeMemory(forge->device, (VkDeviceMemory)entry.handle, nullptr); break;
-				case VK_OBJECT_TYPE_DEVICE:                vkDestroyDevice(forge->device, nullptr); break;
-				case VK_OBJECT_TYPE_INSTANCE:              vkDestroyInstance(forge->instance, nullptr); break;
-				default:
-					log_error("object type '{}' is not handled", _forge_object_type_str(entry.type));
-					assert(false);
-					break;
-				}
-				return true;
-			}
+		// Due entries are taken out under the lock and destroyed after releasing it, callbacks are free to defer more
+		// objects into the queue
+		std::vector<ForgeDeletionQueue::Entry> due;
+		{
+			std::lock_guard<std::mutex> lock(queue->mutex);
+
+			auto iter = std::stable_partition(queue->entries.begin(), queue->entries.end(), [immediate, value](const ForgeDeletionQueue::Entry& entry) {
+				return (immediate || value >= entry.signal) == false;
+			});
 
-			return false;
-		});
+			due.assign(std::make_move_iterator(iter), std::make_move_iterator(queue->entries.end()));
+			queue->entries.erase(iter, queue->entries.end());
+		}
 
-		queue->entries.erase(iter, queue->entries.end());
+		for (auto& entry : due)
+		{
+			_forge_deletion_queue_entry_destroy(forge, entry);
+		}
 	}
 
 	void
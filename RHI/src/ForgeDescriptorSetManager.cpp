@@ -7,144 +7,325 @@
 #include "ForgeUtils.h"
 #include "ForgeDynamicMemory.h"
 #include "ForgeBuffer.h"
+#include "ForgeSampler.h"
 
 namespace forge
 {
-	static uint64_t
-	_forge_bindings_hash(const ForgeBindingList& bindings)
+	static bool
+	_forge_descriptor_type_image(VkDescriptorType type)
 	{
-		uint64_t seed = 0u;
+		return type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER || type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	}
 
-		for (auto& image : bindings.images)
+	static bool
+	_forge_descriptor_set_bindings_check(ForgeShader* shader, uint32_t set_index, ForgeBindingList* binding_list)
+	{
+		auto& shader_description = shader->description;
+
+		for (auto& binding : shader->set_bindings[set_index])
 		{
-			if (image == nullptr)
-				continue;
+			if (binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER && binding_list->storage_buffers[binding.binding] == nullptr)
+			{
+				log_error("The storage buffer '{}' of the shader '{}' is not bound", shader_description.storage_buffers[binding.binding].name, shader_description.name);
+				return false;
+			}
 
-			_forge_hash_combine(seed, image->handle);
-			_forge_hash_combine(seed, image->memory);
+			if (_forge_descriptor_type_image(binding.descriptorType) && binding_list->images[binding.binding] == nullptr)
+			{
+				log_error("The image '{}' of the shader '{}' is not bound", shader_description.images[binding.binding].name, shader_description.name);
+				return false;
+			}
 		}
 
-		return seed;
+		return true;
 	}
 
-	static void
-	_forge_descriptor_set_update(Forge* forge, VkDescriptorSet set, const ForgeShaderDescription& shader_description, ForgeBindingList* binding_list)
+	// Fills one payload entry per descriptor in the order the shader's update template reads them, unbound resources
+	// are left as null handles
+	static uint32_t
+	_forge_descriptor_set_payload_fill(Forge* forge, ForgeShader* shader, uint32_t set_index, ForgeBindingList* binding_list, ForgeDescriptorPayloadEntry* payload)
 	{
-		VkWriteDescriptorSet MAX_WRITES[FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS + FORGE_MAX_IMAGE_BINDINGS] = {};
-		VkDescriptorBufferInfo MAX_BUFFERS[FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS] = {};
-		VkDescriptorImageInfo MAX_IMAGES[FORGE_MAX_IMAGE_BINDINGS] = {};
-		uint32_t buffers_count = 0u;
-		uint32_t images_count = 0u;
+		auto& bindings = shader->set_bindings[set_index];
 
-		auto& uniforms = shader_description.uniforms;
-		for (uint32_t i = 0; i < FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS; ++i)
+		for (uint32_t i = 0; i < (uint32_t)bindings.size(); ++i)
 		{
-			if (uniforms[i].name.empty() == true)
-				continue;
+			auto& binding = bindings[i];
+			auto& entry = payload[i];
+			auto buffer = binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ? binding_list->storage_buffers[binding.binding] : nullptr;
+			auto image = _forge_descriptor_type_image(binding.descriptorType) ? binding_list->images[binding.binding] : nullptr;
+			auto sampler = image ? (binding_list->samplers[binding.binding] ? binding_list->samplers[binding.binding] : image->sampler) : nullptr;
 
-			auto& buffer_write_info = MAX_BUFFERS[buffers_count];
-			buffer_write_info.buffer = forge->uniform_memory->buffer->handle;
-			buffer_write_info.offset = 0u;
-			buffer_write_info.range  = uniforms[i].size;
-
-			auto& write_info = MAX_WRITES[buffers_count];
-			write_info.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			write_info.dstSet = set;
-			write_info.dstBinding = i;
-			write_info.dstArrayElement = 0u;
-			write_info.descriptorCount = 1u;
-			write_info.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-			write_info.pBufferInfo = &buffer_write_info;
-
-			++buffers_count;
+			switch (binding.descriptorType)
+			{
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER: // Pushed sets, the offset is patched in by the push
+				entry.buffer.buffer = forge->uniform_memory->buffer->handle;
+				entry.buffer.offset = 0u;
+				entry.buffer.range = shader->description.uniforms[binding.binding].size;
+				break;
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+				entry.buffer.buffer = buffer ? buffer->handle : VK_NULL_HANDLE;
+				entry.buffer.offset = 0u;
+				entry.buffer.range = VK_WHOLE_SIZE;
+				break;
+			case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+				entry.image.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				entry.image.imageView = image ? image->shader_view : VK_NULL_HANDLE;
+				entry.image.sampler = sampler ? sampler->handle : VK_NULL_HANDLE;
+				break;
+			case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+				entry.image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+				entry.image.imageView = image ? image->shader_view : VK_NULL_HANDLE;
+				entry.image.sampler = VK_NULL_HANDLE;
+				break;
+			default:
+				assert(false);
+				break;
+			}
 		}
 
-		auto& images = shader_description.images;
-		for (uint32_t i = 0; i < FORGE_MAX_IMAGE_BINDINGS; ++i)
-		{
-			auto& image_layout = images[i];
-			if (image_layout.name.empty() == true)
-				continue;
+		return (uint32_t)bindings.size();
+	}
 
-			auto& image_write_info = MAX_IMAGES[images_count];
-			image_write_info.imageLayout = image_layout.storage ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			image_write_info.imageView = binding_list->images[i]->shader_view;
-			image_write_info.sampler = image_layout.storage ? VK_NULL_HANDLE : binding_list->images[i]->sampler;
-
-			auto& write_info = MAX_WRITES[images_count + buffers_count];
-			write_info.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			write_info.dstSet = set;
-			write_info.dstBinding = i;
-			write_info.dstArrayElement = 0u;
-			write_info.descriptorCount = 1u;
-			write_info.descriptorType = image_layout.storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			write_info.pImageInfo = &image_write_info;
-
-			++images_count;
+	// The payload is what the set ends up holding so it doubles as the cache key, the bound resources' memory is mixed
+	// in since a recreated resource might get the handle of a destroyed one
+	static uint64_t
+	_forge_descriptor_set_payload_hash(ForgeShader* shader, uint32_t set_index, ForgeBindingList* binding_list, const ForgeDescriptorPayloadEntry* payload, uint32_t count)
+	{
+		uint64_t seed = _forge_hash_bytes(payload, count * sizeof(ForgeDescriptorPayloadEntry), set_index);
+
+		for (auto& binding : shader->set_bindings[set_index])
+		{
+			if (binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER && binding_list->storage_buffers[binding.binding])
+			{
+				auto buffer = binding_list->storage_buffers[binding.binding];
+				_forge_hash_combine(seed, buffer->memory.memory);
+				_forge_hash_combine(seed, buffer->memory.offset);
+			}
+			else if (_forge_descriptor_type_image(binding.descriptorType) && binding_list->images[binding.binding])
+			{
+				auto image = binding_list->images[binding.binding];
+				_forge_hash_combine(seed, image->memory.memory);
+				_forge_hash_combine(seed, image->memory.offset);
+
+				auto sampler = binding_list->samplers[binding.binding] ? binding_list->samplers[binding.binding] : image->sampler;
+				if (sampler)
+				{
+					_forge_hash_combine(seed, sampler->hash);
+				}
+			}
 		}
 
-		vkUpdateDescriptorSets(forge->device, images_count + buffers_count, MAX_WRITES, 0u, nullptr);
+		return seed;
+	}
+
+	static uint64_t
+	_forge_descriptor_set_key(VkDescriptorSetLayout layout, uint64_t bindings_hash)
+	{
+		uint64_t seed = bindings_hash;
+		_forge_hash_combine(seed, layout);
+
+		return seed;
 	}
 
 	static void
-	_forge_descriptor_set_manager_free(Forge* forge, ForgeDescriptorSetManager* manager)
+	_forge_descriptor_set_list_remove(ForgeDescriptorSetManager* manager, ForgeDescriptorSetList& list, uint32_t index)
 	{
-		if (manager->pool)
-		{
-			vkDestroyDescriptorPool(forge->device, manager->pool, nullptr);
-		}
+		auto& sets = manager->allocated_sets;
+		auto& set = sets[index];
+
+		if (set.prev != FORGE_DESCRIPTOR_SET_INVALID_INDEX) sets[set.prev].next = set.next; else list.head = set.next;
+		if (set.next != FORGE_DESCRIPTOR_SET_INVALID_INDEX) sets[set.next].prev = set.prev; else list.tail = set.prev;
+
+		set.prev = FORGE_DESCRIPTOR_SET_INVALID_INDEX;
+		set.next = FORGE_DESCRIPTOR_SET_INVALID_INDEX;
 	}
 
-	ForgeDescriptorSetManager*
-	forge_descriptor_set_manager_new(Forge* forge)
+	static void
+	_forge_descriptor_set_list_push_back(ForgeDescriptorSetManager* manager, ForgeDescriptorSetList& list, uint32_t index)
 	{
-		auto manager = new ForgeDescriptorSetManager();
+		auto& sets = manager->allocated_sets;
+		auto& set = sets[index];
+
+		set.prev = list.tail;
+		set.next = FORGE_DESCRIPTOR_SET_INVALID_INDEX;
+
+		if (list.tail != FORGE_DESCRIPTOR_SET_INVALID_INDEX) sets[list.tail].next = index; else list.head = index;
+		list.tail = index;
+	}
+
+	// Sets are always pushed back with the latest signal so the list stays ordered by release signal
+	static void
+	_forge_descriptor_set_touch(Forge* forge, ForgeDescriptorSetManager* manager, ForgeDescriptorSetList& list, uint32_t index)
+	{
+		auto& set = manager->allocated_sets[index];
+		if (set.release_signal == forge->timeline_next_signal && list.tail == index)
+			return;
+
+		set.release_signal = forge->timeline_next_signal;
+		_forge_descriptor_set_list_remove(manager, list, index);
+		_forge_descriptor_set_list_push_back(manager, list, index);
+	}
 
+	static bool
+	_forge_descriptor_set_manager_pool_add(Forge* forge, ForgeDescriptorSetManager* manager)
+	{
 		VkDescriptorPoolSize pool_sizes[] = {
-			{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, FORGE_DESCRIPTOR_SET_MANAGER_MAX_DYNAMIC_UNIFORM_BUFFERS},
-			{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, FORGE_DESCRIPTOR_SET_MANAGER_MAX_SAMPLED_IMAGES},
-			{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, FORGE_DESCRIPTOR_SET_MANAGER_MAX_STORAGE_IMAGES}
+			{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, FORGE_DESCRIPTOR_SET_MANAGER_POOL_MAX_DYNAMIC_UNIFORM_BUFFERS},
+			{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, FORGE_DESCRIPTOR_SET_MANAGER_POOL_MAX_SAMPLED_IMAGES},
+			{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, FORGE_DESCRIPTOR_SET_MANAGER_POOL_MAX_STORAGE_IMAGES},
+			{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, FORGE_DESCRIPTOR_SET_MANAGER_POOL_MAX_STORAGE_BUFFERS}
 		};
 
 		VkDescriptorPoolCreateInfo info {};
 		info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		info.maxSets = FORGE_DESCRIPTOR_SET_MANAGER_MAX_DESCRIPTOR_SETS;
+		info.maxSets = FORGE_DESCRIPTOR_SET_MANAGER_POOL_MAX_DESCRIPTOR_SETS;
 		info.poolSizeCount = sizeof(pool_sizes) / sizeof(pool_sizes[0]);
 		info.pPoolSizes = pool_sizes;
-		auto res = vkCreateDescriptorPool(forge->device, &info, nullptr, &manager->pool);
+
+		VkDescriptorPool pool = VK_NULL_HANDLE;
+		auto res = vkCreateDescriptorPool(forge->device, &info, nullptr, &pool);
+		VK_RES_CHECK(res);
+
+		if (res != VK_SUCCESS)
+		{
+			log_error("Failed to create a descriptor pool, the following error code '{}' is reported", _forge_result_to_str(res));
+			return false;
+		}
+
+		manager->pools.push_back(pool);
+
+		log_info("Descriptor set manager grew to '{}' pools", manager->pools.size());
+
+		return true;
+	}
+
+	static VkDescriptorSet
+	_forge_descriptor_set_allocate(Forge* forge, ForgeDescriptorSetManager* manager, VkDescriptorSetLayout layout)
+	{
+		VkDescriptorSetAllocateInfo allocate_info {};
+		allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocate_info.descriptorSetCount = 1u;
+		allocate_info.pSetLayouts = &layout;
+		allocate_info.descriptorPool = manager->pools.back();
+
+		VkDescriptorSet set = VK_NULL_HANDLE;
+		auto res = vkAllocateDescriptorSets(forge->device, &allocate_info, &set);
+
+		// Running out of pool space is expected, grow instead of failing
+		if (res == VK_ERROR_OUT_OF_POOL_MEMORY || res == VK_ERROR_FRAGMENTED_POOL)
+		{
+			if (_forge_descriptor_set_manager_pool_add(forge, manager) == false)
+			{
+				return VK_NULL_HANDLE;
+			}
+
+			allocate_info.descriptorPool = manager->pools.back();
+			res = vkAllocateDescriptorSets(forge->device, &allocate_info, &set);
+		}
 		VK_RES_CHECK(res);
 
+		if (res != VK_SUCCESS)
+		{
+			log_error("Failed to allocate a descriptor set, the following error code '{}' is reported", _forge_result_to_str(res));
+			return VK_NULL_HANDLE;
+		}
+
+		return set;
+	}
+
+	static void
+	_forge_descriptor_set_manager_free(Forge* forge, ForgeDescriptorSetManager* manager)
+	{
+		for (auto pool : manager->pools)
+		{
+			vkDestroyDescriptorPool(forge->device, pool, nullptr);
+		}
+
+		manager->pools.clear();
+	}
+
+	ForgeDescriptorSetManager*
+	forge_descriptor_set_manager_new(Forge* forge)
+	{
+		auto manager = new ForgeDescriptorSetManager();
+
+		if (_forge_descriptor_set_manager_pool_add(forge, manager) == false)
+		{
+			forge_descriptor_set_manager_destroy(forge, manager);
+			return nullptr;
+		}
+
 		return manager;
 	}
 
+	uint64_t
+	forge_descriptor_set_bindings_hash(Forge* forge, ForgeShader* shader, uint32_t set_index, ForgeBindingList* binding_list)
+	{
+		ForgeDescriptorPayloadEntry payload[FORGE_SHADER_MAX_SET_DESCRIPTORS] {};
+		auto count = _forge_descriptor_set_payload_fill(forge, shader, set_index, binding_list, payload);
+
+		return _forge_descriptor_set_payload_hash(shader, set_index, binding_list, payload, count);
+	}
+
 	VkDescriptorSet
-	forge_descriptor_set_acquire(Forge* forge, ForgeDescriptorSetManager* manager, ForgeShader* shader, ForgeBindingList* binding_list)
+	forge_descriptor_set_acquire(Forge* forge, ForgeDescriptorSetManager* manager, ForgeShader* shader, uint32_t set_index, ForgeBindingList* binding_list)
 	{
-		auto bindings_hash = _forge_bindings_hash(*binding_list);
-		auto layout = shader->descriptor_set_layout;
+		if (_forge_descriptor_set_bindings_check(shader, set_index, binding_list) == false)
+		{
+			return VK_NULL_HANDLE;
+		}
 
-		uint64_t value;
-		auto res = vkGetSemaphoreCounterValue(forge->device, forge->timeline, &value);
-		VK_RES_CHECK(res);
+		// Zero initialized so the padding of image entries hashes consistently
+		ForgeDescriptorPayloadEntry payload[FORGE_SHADER_MAX_SET_DESCRIPTORS] {};
+		auto count = _forge_descriptor_set_payload_fill(forge, shader, set_index, binding_list, payload);
+
+		auto bindings_hash = _forge_descriptor_set_payload_hash(shader, set_index, binding_list, payload, count);
+		auto layout = shader->descriptor_set_layouts[set_index];
+		auto update_template = shader->descriptor_update_templates[set_index];
+
+		std::lock_guard<std::mutex> lock(manager->mutex);
 
-		for (auto& set : manager->allocated_sets)
+		auto key = _forge_descriptor_set_key(layout, bindings_hash);
+		auto& list = manager->layout_sets[layout];
+
+		auto iter = manager->sets_lookup.find(key);
+		if (iter != manager->sets_lookup.end())
 		{
+			auto index = iter->second;
+			auto& set = manager->allocated_sets[index];
+
 			if (set.layout == layout && set.active_bindings_hash == bindings_hash)
 			{
-				set.release_signal = forge->timeline_next_signal;
+				_forge_descriptor_set_touch(forge, manager, list, index);
 
 				return set.handle;
 			}
 		}
 
-		for (auto& set : manager->allocated_sets)
+		uint64_t value;
+		auto res = vkGetSemaphoreCounterValue(forge->device, forge->timeline, &value);
+		VK_RES_CHECK(res);
+
+		// The head of the list is the least recently used set of this layout, if it aged out it can be rewritten
+		if (list.head != FORGE_DESCRIPTOR_SET_INVALID_INDEX)
 		{
-			if (set.layout == layout && (value >= set.release_signal && value - set.release_signal >= FORGE_DESCRIPTOR_SET_MANAGER_SET_MAX_AGE))
+			auto index = list.head;
+			auto& set = manager->allocated_sets[index];
+
+			if (value >= set.release_signal && value - set.release_signal >= FORGE_DESCRIPTOR_SET_MANAGER_SET_MAX_AGE)
 			{
-				_forge_descriptor_set_update(forge, set.handle, shader->description, binding_list);
+				auto old = manager->sets_lookup.find(_forge_descriptor_set_key(set.layout, set.active_bindings_hash));
+				if (old != manager->sets_lookup.end() && old->second == index)
+				{
+					manager->sets_lookup.erase(old);
+				}
+
+				vkUpdateDescriptorSetWithTemplate(forge->device, set.handle, update_template, payload);
 
 				set.active_bindings_hash = bindings_hash;
-				set.release_signal = forge->timeline_next_signal;
+				_forge_descriptor_set_touch(forge, manager, list, index);
+				manager->sets_lookup[key] = index;
 
 				return set.handle;
 			}
@@ -154,22 +335,53 @@ namespace forge
 		set.active_bindings_hash = bindings_hash;
 		set.layout = layout;
 		set.release_signal = forge->timeline_next_signal;
+		set.prev = FORGE_DESCRIPTOR_SET_INVALID_INDEX;
+		set.next = FORGE_DESCRIPTOR_SET_INVALID_INDEX;
+		set.handle = _forge_descriptor_set_allocate(forge, manager, layout);
 
-		VkDescriptorSetAllocateInfo allocate_info {};
-		allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-		allocate_info.descriptorSetCount = 1u;
-		allocate_info.pSetLayouts = &shader->descriptor_set_layout;
-		allocate_info.descriptorPool = manager->pool;
-		res = vkAllocateDescriptorSets(forge->device, &allocate_info, &set.handle);
-		VK_RES_CHECK(res);
+		if (set.handle == VK_NULL_HANDLE)
+		{
+			return VK_NULL_HANDLE;
+		}
 
-		_forge_descriptor_set_update(forge, set.handle, shader->description, binding_list);
+		vkUpdateDescriptorSetWithTemplate(forge->device, set.handle, update_template, payload);
 
+		auto index = (uint32_t)manager->allocated_sets.size();
 		manager->allocated_sets.push_back(set);
+		_forge_descriptor_set_list_push_back(manager, list, index);
+		manager->sets_lookup[key] = index;
 
 		return set.handle;
 	}
 
+	bool
+	forge_descriptor_set_push(Forge* forge, VkCommandBuffer command_buffer, ForgeShader* shader, uint32_t set_index, ForgeBindingList* binding_list)
+	{
+		assert(shader->push_descriptors && set_index == FORGE_SHADER_SET_DRAW);
+
+		if (_forge_descriptor_set_bindings_check(shader, set_index, binding_list) == false)
+		{
+			return false;
+		}
+
+		ForgeDescriptorPayloadEntry payload[FORGE_SHADER_MAX_SET_DESCRIPTORS] {};
+		_forge_descriptor_set_payload_fill(forge, shader, set_index, binding_list, payload);
+
+		auto& bindings = shader->set_bindings[set_index];
+		for (uint32_t i = 0; i < (uint32_t)bindings.size(); ++i)
+		{
+			auto uniform = binding_list->uniforms[bindings[i].binding];
+			if (bindings[i].descriptorType != VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER || uniform.first == 0)
+				continue;
+
+			payload[i].buffer.offset = forge_dynamic_memory_write(forge, forge->uniform_memory, uniform.first, forge->physical_device_limits.minUniformBufferOffsetAlignment, uniform.second);
+		}
+
+		forge->pfn_vkCmdPushDescriptorSetWithTemplateKHR(command_buffer, shader->descriptor_update_templates[set_index], shader->pipeline_layout, set_index, payload);
+
+		return true;
+	}
+
 	void
 	forge_descriptor_set_manager_destroy(Forge* forge, ForgeDescriptorSetManager* manager)
 	{
@@ -102,6 +102,8 @@ namespace forge
 	uint64_t
 	forge_dynamic_memory_write(Forge* forge, ForgeDynamicMemory* memory, uint32_t size, uint32_t alignment, void* data)
 	{
+		std::lock_guard<std::mutex> lock(memory->mutex);
+
 		auto buffer = memory->buffer;
 		uint32_t& current = memory->current;
 
@@ -12,9 +12,24 @@
 #include "ForgeDescriptorSetManager.h"
 #include "ForgeDynamicMemory.h"
 #include "ForgeDeletionQueue.h"
+#include "ForgeBindless.h"
 
 namespace forge
 {
+	static void
+	_forge_frame_bound_state_reset(ForgeFrame* frame)
+	{
+		frame->bound_layout = VK_NULL_HANDLE;
+		frame->bound_pipeline = VK_NULL_HANDLE;
+		frame->bound_shader = nullptr;
+		frame->pipeline_missing = false;
+
+		for (auto& state : frame->bound_sets)
+		{
+			state = ForgeFrameSetState{};
+		}
+	}
+
 	static void
 	_forge_frame_pass_update(Forge* forge, ForgeFrame* frame, uint32_t width, uint32_t height)
 	{
@@ -82,9 +97,59 @@ namespace forge
 		}
 	}
 
+	static void
+	_forge_frame_resources_transition(Forge* forge, ForgeFrame* frame)
+	{
+		auto shader = frame->resources_list.shader;
+
+		for (uint32_t i = 0; i < FORGE_MAX_IMAGE_BINDINGS; ++i)
+		{
+			auto image = frame->resources_list.images[i];
+			if (image == nullptr)
+				continue;
+
+			auto storage = shader->description.images[i].storage;
+			forge_image_layout_transition(forge, frame->command_buffer, storage ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, image);
+		}
+
+		for (uint32_t i = 0; i < FORGE_MAX_STORAGE_BUFFER_BINDINGS; ++i)
+		{
+			auto buffer = frame->resources_list.storage_buffers[i];
+			if (buffer == nullptr)
+				continue;
+
+			auto& buffer_layout = shader->description.storage_buffers[i];
+			auto access = buffer_layout.readonly ? VK_ACCESS_SHADER_READ_BIT : VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			forge_buffer_barrier(forge, frame->command_buffer, _forge_shader_stages_pipeline_stage(buffer_layout.stages), access, buffer);
+		}
+	}
+
+	static bool
+	_forge_frame_indirect_buffer_check(ForgeBuffer* buffer)
+	{
+		if ((buffer->description.usage & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT) == 0)
+		{
+			log_error("The provided buffer '{}' is not an indirect buffer", buffer->description.name);
+			return false;
+		}
+
+		return true;
+	}
+
+	// Nothing can be drawn while the bound shader has no pipeline, it is either still compiling or failed to compile
+	static bool
+	_forge_frame_draw_check(ForgeFrame* frame)
+	{
+		return frame->pipeline_missing == false;
+	}
+
 	static void
 	_forge_frame_free(Forge* forge, ForgeFrame* frame)
 	{
+		// Secondary frames borrow their parent's pass
+		if (frame->parent)
+			return;
+
 		forge_image_destroy(forge, frame->pass->description.colors[0].image);
 		forge_image_destroy(forge, frame->pass->description.depth.image);
 		forge_swapchain_destroy(forge, frame->swapchain);
@@ -148,6 +213,12 @@ namespace forge
 	ForgeFrame*
 	forge_frame_new(Forge* forge, ForgeSwapchainDescription swapchain_desc)
 	{
+		if (forge->description.headless)
+		{
+			log_error("A swapchain frame can't be created by a headless forge");
+			return nullptr;
+		}
+
 		auto frame = new ForgeFrame();
 		forge->swapchain_frame = frame;
 
@@ -165,17 +236,21 @@ namespace forge
 	forge_frame_prepare(Forge* forge, ForgeFrame* frame, ForgeShader* shader, ForgeBindingList* binding_list, uint32_t width, uint32_t height)
 	{
 		frame->command_buffer = forge_command_buffer_acquire(forge, forge->command_buffer_manager, true);
-		frame->set = forge_descriptor_set_acquire(forge, forge->descriptor_set_manager, shader, binding_list);
+		_forge_frame_bound_state_reset(frame);
 
+		frame->resources_list.shader = shader;
 		for (uint32_t i = 0; i < FORGE_MAX_IMAGE_BINDINGS; ++i)
 		{
-			auto image = binding_list->images[i];
-			if (image == nullptr)
-				continue;
+			frame->resources_list.images[i] = binding_list->images[i];
+		}
 
-			forge_image_layout_transition(forge, frame->command_buffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, image);
+		for (uint32_t i = 0; i < FORGE_MAX_STORAGE_BUFFER_BINDINGS; ++i)
+		{
+			frame->resources_list.storage_buffers[i] = binding_list->storage_buffers[i];
 		}
 
+		_forge_frame_resources_transition(forge, frame);
+
 		if (frame->swapchain)
 		{
 			forge_swapchain_update(forge, frame->swapchain);
@@ -183,21 +258,17 @@ namespace forge
 
 		_forge_frame_pass_update(forge, frame, width, height);
 
-		if (frame->pass->handle != shader->active_pass)
-		{
-			if (shader->pipeline != VK_NULL_HANDLE)
-			{
-				forge_deletion_queue_push(forge, forge->deletion_queue, shader->pipeline);
-			}
-
-			_forge_shader_pipeline_init(forge, shader, frame->pass->handle);
-		}
+		// Compilation starts here rather than on the first draw
+		forge_shader_pipeline_request(forge, shader, frame->pass);
 	}
 
 	bool
-	forge_frame_begin(Forge* forge, ForgeFrame* frame)
+	forge_frame_begin(Forge* forge, ForgeFrame* frame, VkSubpassContents contents)
 	{
-		forge_render_pass_begin(forge, frame->command_buffer, frame->pass);
+		// Dispatches recorded since prepare might have moved the pass's images to another layout or written its buffers
+		_forge_frame_resources_transition(forge, frame);
+
+		forge_render_pass_begin(forge, frame->command_buffer, frame->pass, contents);
 
 		return true;
 	}
@@ -205,11 +276,154 @@ namespace forge
 	void
 	forge_frame_draw(Forge* forge, ForgeFrame* frame, uint32_t vertex_count)
 	{
+		if (_forge_frame_draw_check(frame) == false)
+			return;
+
 		auto command_buffer = frame->command_buffer;
 
 		vkCmdDraw(command_buffer, vertex_count, 1u, 0u, 0u);
 	}
 
+	void
+	forge_frame_draw_instanced(Forge* forge, ForgeFrame* frame, uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance)
+	{
+		if (_forge_frame_draw_check(frame) == false)
+			return;
+
+		auto command_buffer = frame->command_buffer;
+
+		vkCmdDraw(command_buffer, vertex_count, instance_count, first_vertex, first_instance);
+	}
+
+	void
+	forge_frame_draw_indexed(Forge* forge, ForgeFrame* frame, uint32_t index_count, uint32_t first_index, int32_t vertex_offset)
+	{
+		if (_forge_frame_draw_check(frame) == false)
+			return;
+
+		auto command_buffer = frame->command_buffer;
+
+		vkCmdDrawIndexed(command_buffer, index_count, 1u, first_index, vertex_offset, 0u);
+	}
+
+	void
+	forge_frame_draw_indexed_instanced(Forge* forge, ForgeFrame* frame, uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance)
+	{
+		if (_forge_frame_draw_check(frame) == false)
+			return;
+
+		auto command_buffer = frame->command_buffer;
+
+		vkCmdDrawIndexed(command_buffer, index_count, instance_count, first_index, vertex_offset, first_instance);
+	}
+
+	void
+	forge_frame_draw_indirect(Forge* forge, ForgeFrame* frame, ForgeBuffer* buffer, uint64_t offset, uint32_t draw_count, uint32_t stride)
+	{
+		if (_forge_frame_draw_check(frame) == false)
+			return;
+
+		auto command_buffer = frame->command_buffer;
+
+		if (_forge_frame_indirect_buffer_check(buffer) == false)
+			return;
+
+		if (draw_count <= 1u || forge->physical_device_features.multiDrawIndirect)
+		{
+			vkCmdDrawIndirect(command_buffer, buffer->handle, offset, draw_count, stride);
+			return;
+		}
+
+		for (uint32_t i = 0; i < draw_count; ++i)
+		{
+			vkCmdDrawIndirect(command_buffer, buffer->handle, offset + (uint64_t)i * stride, 1u, stride);
+		}
+	}
+
+	void
+	forge_frame_draw_indexed_indirect(Forge* forge, ForgeFrame* frame, ForgeBuffer* buffer, uint64_t offset, uint32_t draw_count, uint32_t stride)
+	{
+		if (_forge_frame_draw_check(frame) == false)
+			return;
+
+		auto command_buffer = frame->command_buffer;
+
+		if (_forge_frame_indirect_buffer_check(buffer) == false)
+			return;
+
+		if (draw_count <= 1u || forge->physical_device_features.multiDrawIndirect)
+		{
+			vkCmdDrawIndexedIndirect(command_buffer, buffer->handle, offset, draw_count, stride);
+			return;
+		}
+
+		for (uint32_t i = 0; i < draw_count; ++i)
+		{
+			vkCmdDrawIndexedIndirect(command_buffer, buffer->handle, offset + (uint64_t)i * stride, 1u, stride);
+		}
+	}
+
+	void
+	forge_frame_draw_indirect_count(Forge* forge, ForgeFrame* frame, ForgeBuffer* buffer, uint64_t offset, ForgeBuffer* count_buffer, uint64_t count_offset, uint32_t max_draw_count, uint32_t stride)
+	{
+		if (_forge_frame_draw_check(frame) == false)
+			return;
+
+		auto command_buffer = frame->command_buffer;
+
+		if (forge->physical_device_features_12.drawIndirectCount == VK_FALSE)
+		{
+			log_error("Device doesn't support drawIndirectCount, the count can't be read from a buffer");
+			return;
+		}
+
+		if (_forge_frame_indirect_buffer_check(buffer) == false || _forge_frame_indirect_buffer_check(count_buffer) == false)
+			return;
+
+		vkCmdDrawIndirectCount(command_buffer, buffer->handle, offset, count_buffer->handle, count_offset, max_draw_count, stride);
+	}
+
+	void
+	forge_frame_draw_indexed_indirect_count(Forge* forge, ForgeFrame* frame, ForgeBuffer* buffer, uint64_t offset, ForgeBuffer* count_buffer, uint64_t count_offset, uint32_t max_draw_count, uint32_t stride)
+	{
+		if (_forge_frame_draw_check(frame) == false)
+			return;
+
+		auto command_buffer = frame->command_buffer;
+
+		if (forge->physical_device_features_12.drawIndirectCount == VK_FALSE)
+		{
+			log_error("Device doesn't support drawIndirectCount, the count can't be read from a buffer");
+			return;
+		}
+
+		if (_forge_frame_indirect_buffer_check(buffer) == false || _forge_frame_indirect_buffer_check(count_buffer) == false)
+			return;
+
+		vkCmdDrawIndexedIndirectCount(command_buffer, buffer->handle, offset, count_buffer->handle, count_offset, max_draw_count, stride);
+	}
+
+	void
+	forge_frame_push_constants(Forge* forge, ForgeFrame* frame, ForgeShader* shader, const void* data, uint32_t size)
+	{
+		auto command_buffer = frame->command_buffer;
+		auto& push_constants = shader->description.push_constants;
+
+		if (push_constants.stages == 0u)
+		{
+			log_error("The shader '{}' doesn't declare a push constant block", shader->description.name);
+			return;
+		}
+
+		if (size > push_constants.size || size % 4u != 0u)
+		{
+			log_error("The provided size '{}' must be a multiple of 4 that fits the push constant block's size '{}'", size, push_constants.size);
+			return;
+		}
+
+		vkCmdPushConstants(command_buffer, shader->pipeline_layout, push_constants.stages, 0u, size, data);
+	}
+
 	void
 	forge_frame_end(Forge* forge, ForgeFrame* frame)
 	{
@@ -250,34 +464,188 @@ namespace forge
 	forge_frame_bind_resources(Forge* forge, ForgeFrame* frame, ForgeShader* shader, ForgeBindingList* binding_list)
 	{
 		auto command_buffer = frame->command_buffer;
-		auto set = frame->set;
+		auto& uniforms = shader->description.uniforms;
 
-		for (uint32_t i = 0; i < FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS; ++i)
+		// Sets bound with another layout can't be trusted to stay compatible
+		if (frame->bound_layout != shader->pipeline_layout)
 		{
-			auto uniform = binding_list->uniforms[i];
-			if (uniform.first == 0)
-				continue;
+			_forge_frame_bound_state_reset(frame);
+			frame->bound_layout = shader->pipeline_layout;
 
-			shader->uniform_offsets[i] = forge_dynamic_memory_write(forge, forge->uniform_memory, uniform.first, forge->physical_device_limits.minUniformBufferOffsetAlignment, uniform.second);
+			if (shader->bindless)
+			{
+				vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->pipeline_layout, FORGE_BINDLESS_SET, 1u, &forge->bindless_table->set, 0u, nullptr);
+			}
+		}
+
+		// The pass can't change while recording, the pipeline only needs a lookup when the shader does
+		if (frame->bound_shader != shader)
+		{
+			// Draws are skipped while the pipeline is compiling in the background and the lookup is retried on the next
+			// bind. A failed pipeline is never retried, the failure is reported once when it happens.
+			auto state = forge_shader_pipeline_request(forge, shader, frame->pass);
+			frame->pipeline_missing = state != FORGE_SHADER_PIPELINE_STATE_READY;
+			frame->bound_shader = state == FORGE_SHADER_PIPELINE_STATE_COMPILING ? nullptr : shader;
+
+			auto pipeline = state == FORGE_SHADER_PIPELINE_STATE_READY ? forge_shader_pipeline_get(forge, shader, frame->pass) : VK_NULL_HANDLE;
+			if (pipeline && pipeline != frame->bound_pipeline)
+			{
+				vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+				frame->bound_pipeline = pipeline;
+			}
 		}
 
 		VkDeviceSize offset{};
 
-		for (auto& vertex_buffer : binding_list->vertex_buffers)
+		for (uint32_t i = 0; i < FORGE_MAX_VERTEX_BUFFER_BINDINGS; ++i)
 		{
+			auto vertex_buffer = binding_list->vertex_buffers[i];
 			if (vertex_buffer)
 			{
-				vkCmdBindVertexBuffers(command_buffer, 0u, 1u, &vertex_buffer->handle, &offset);
+				vkCmdBindVertexBuffers(command_buffer, i, 1u, &vertex_buffer->handle, &offset);
 			}
 		}
 
 		if (binding_list->index_buffer)
 		{
-			vkCmdBindIndexBuffer(command_buffer, binding_list->index_buffer->handle, 0u, VK_INDEX_TYPE_UINT32);
+			vkCmdBindIndexBuffer(command_buffer, binding_list->index_buffer->handle, 0u, binding_list->index_type);
+		}
+
+		for (uint32_t set_index = 0; set_index < shader->sets_count; ++set_index)
+		{
+			if (shader->set_bindings[set_index].empty())
+				continue;
+
+			auto& state = frame->bound_sets[set_index];
+			auto bindings_hash = forge_descriptor_set_bindings_hash(forge, shader, set_index, binding_list);
+
+			// Uniforms live in dynamic memory, only their contents decide whether they need to be written again
+			uint64_t uniforms_hash = set_index;
+			for (uint32_t i = 0; i < FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS; ++i)
+			{
+				auto uniform = binding_list->uniforms[i];
+				if (uniforms[i].stages == 0u || uniforms[i].set != set_index || uniform.first == 0)
+					continue;
+
+				_forge_hash_combine(uniforms_hash, _forge_hash_bytes(uniform.second, uniform.first, i));
+			}
+
+			bool bindings_dirty = state.bound == false || state.bindings_hash != bindings_hash;
+			bool uniforms_dirty = state.bound == false || state.uniforms_hash != uniforms_hash;
+			if (bindings_dirty == false && uniforms_dirty == false)
+				continue;
+
+			// Pushed sets are written whole, there's nothing to reuse
+			if (shader->push_descriptors && set_index == FORGE_SHADER_SET_DRAW)
+			{
+				state = ForgeFrameSetState{};
+				if (forge_descriptor_set_push(forge, command_buffer, shader, set_index, binding_list))
+				{
+					state.bound = true;
+					state.bindings_hash = bindings_hash;
+					state.uniforms_hash = uniforms_hash;
+				}
+				continue;
+			}
+
+			if (bindings_dirty)
+			{
+				auto set = forge_descriptor_set_acquire(forge, forge->descriptor_set_manager, shader, set_index, binding_list);
+				if (set == VK_NULL_HANDLE)
+				{
+					state = ForgeFrameSetState{};
+					continue;
+				}
+
+				state.bound = true;
+				state.handle = set;
+				state.bindings_hash = bindings_hash;
+			}
+
+			// Dynamic offsets are consumed in binding order within the set
+			if (uniforms_dirty)
+			{
+				state.uniform_offsets_count = 0u;
+				for (uint32_t i = 0; i < FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS; ++i)
+				{
+					auto uniform = binding_list->uniforms[i];
+					if (uniforms[i].stages == 0u || uniforms[i].set != set_index)
+						continue;
+
+					uint32_t uniform_offset = 0u;
+					if (uniform.first != 0)
+					{
+						uniform_offset = forge_dynamic_memory_write(forge, forge->uniform_memory, uniform.first, forge->physical_device_limits.minUniformBufferOffsetAlignment, uniform.second);
+					}
+
+					state.uniform_offsets[state.uniform_offsets_count++] = uniform_offset;
+				}
+
+				state.uniforms_hash = uniforms_hash;
+			}
+
+			vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->pipeline_layout, set_index, 1u, &state.handle, state.uniform_offsets_count, state.uniform_offsets);
+		}
+	}
+
+	ForgeFrame*
+	forge_frame_secondary_new(Forge* forge, ForgeFrame* parent)
+	{
+		auto frame = new ForgeFrame();
+		frame->parent = parent;
+
+		return frame;
+	}
+
+	bool
+	forge_frame_secondary_begin(Forge* forge, ForgeFrame* secondary, ForgeShader* shader, ForgeBindingList* binding_list)
+	{
+		// The parent's pass is recreated on resize, always pick the current one
+		auto pass = secondary->parent->pass;
+		if (pass == nullptr)
+		{
+			log_error("A secondary frame can't begin before its parent frame is prepared");
+			return false;
+		}
+
+		secondary->pass = pass;
+
+		forge_shader_pipeline_request(forge, shader, pass);
+
+		secondary->command_buffer = forge_command_buffer_acquire_secondary(forge, forge->command_buffer_manager, pass->handle, pass->framebuffer);
+		if (secondary->command_buffer == VK_NULL_HANDLE)
+		{
+			return false;
+		}
+
+		_forge_frame_bound_state_reset(secondary);
+
+		// Dynamic state isn't inherited from the primary command buffer
+		forge_render_pass_viewport_set(forge, secondary->command_buffer, pass);
+
+		return true;
+	}
+
+	void
+	forge_frame_secondary_end(Forge* forge, ForgeFrame* secondary)
+	{
+		auto res = vkEndCommandBuffer(secondary->command_buffer);
+		VK_RES_CHECK(res);
+	}
+
+	void
+	forge_frame_execute(Forge* forge, ForgeFrame* frame, ForgeFrame** secondaries, uint32_t secondaries_count)
+	{
+		assert(secondaries_count <= FORGE_FRAME_MAX_SECONDARY_FRAMES);
+
+		VkCommandBuffer command_buffers[FORGE_FRAME_MAX_SECONDARY_FRAMES];
+		for (uint32_t i = 0; i < secondaries_count; ++i)
+		{
+			assert(secondaries[i]->parent == frame);
+			command_buffers[i] = secondaries[i]->command_buffer;
 		}
 
-		vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->pipeline_layout, 0u, 1u, &set, shader->uniforms_count, shader->uniform_offsets);
-		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader->pipeline);
+		vkCmdExecuteCommands(frame->command_buffer, secondaries_count, command_buffers);
 	}
 
 	void
@@ -4,6 +4,13 @@
 #include "ForgeUtils.h"
 #include "ForgeBuffer.h"
 #include "ForgeDeletionQueue.h"
+#include "ForgeMemoryAllocator.h"
+#include "ForgeStaging.h"
+#include "ForgeBindless.h"
+#include "ForgeSampler.h"
+
+#include <algorithm>
+#include <cmath>
 
 namespace forge
 {
@@ -57,21 +64,13 @@ namespace forge
 		VkMemoryRequirements mem_requirements;
 		vkGetImageMemoryRequirements(forge->device, image->handle, &mem_requirements);
 
-		VkMemoryAllocateInfo alloc_info{};
-		alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		alloc_info.allocationSize = mem_requirements.size;
-		alloc_info.memoryTypeIndex = _find_memory_type(forge, mem_requirements.memoryTypeBits, image->description.memory_properties);
-
-		res = vkAllocateMemory(forge->device, &alloc_info, nullptr, &image->memory);
-		VK_RES_CHECK(res);
-
-		if (res != VK_SUCCESS)
+		if (forge_memory_allocator_allocate(forge, forge->memory_allocator, mem_requirements, image->description.memory_properties, FORGE_MEMORY_RESOURCE_OPTIMAL, &image->memory) == false)
 		{
 			log_error("Failed to allocate memory for image '{}'", image->description.name);
 			return false;
 		}
 
-		res = vkBindImageMemory(forge->device, image->handle, image->memory, 0);
+		res = vkBindImageMemory(forge->device, image->handle, image->memory.memory, image->memory.offset);
 		VK_RES_CHECK(res);
 
 		// shader view
@@ -110,24 +109,17 @@ namespace forge
 
 		if ((image->description.usage & VK_IMAGE_USAGE_STORAGE_BIT) == 0)
 		{
-			VkSamplerCreateInfo sampler_info{};
-			sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-			sampler_info.magFilter = image->description.mag_filter;
-			sampler_info.minFilter = image->description.min_filter;
-			sampler_info.mipmapMode = image->description.mipmap_mode;
-			sampler_info.addressModeU = image->description.address_mode_u;
-			sampler_info.addressModeV = image->description.address_mode_v;
-			sampler_info.addressModeW = image->description.address_mode_w;
-			sampler_info.mipLodBias = 0.0f;
-			sampler_info.anisotropyEnable = VK_FALSE;
-			sampler_info.compareEnable = VK_FALSE;
-			sampler_info.minLod = 0.0f;
-			sampler_info.maxLod = VK_LOD_CLAMP_NONE;
-			sampler_info.unnormalizedCoordinates = VK_FALSE;
-			res = vkCreateSampler(forge->device, &sampler_info, nullptr, &image->sampler);
-			VK_RES_CHECK(res);
-
-			if (res != VK_SUCCESS)
+			ForgeSamplerDescription sampler_desc{};
+			sampler_desc.mag_filter = image->description.mag_filter;
+			sampler_desc.min_filter = image->description.min_filter;
+			sampler_desc.mipmap_mode = image->description.mipmap_mode;
+			sampler_desc.address_mode_u = image->description.address_mode_u;
+			sampler_desc.address_mode_v = image->description.address_mode_v;
+			sampler_desc.address_mode_w = image->description.address_mode_w;
+			sampler_desc.max_anisotropy = image->description.max_anisotropy;
+			image->sampler = forge_sampler_acquire(forge, forge->sampler_cache, sampler_desc);
+
+			if (image->sampler == nullptr)
 			{
 				log_error("Failed to create the sampler for '{}'", image->description.name);
 				return false;
@@ -142,15 +134,26 @@ namespace forge
 		log_info("Image '{}' initialized successfully", image->description.name);
 		image->view_type = is_cube_map ? VK_IMAGE_VIEW_TYPE_CUBE : VK_IMAGE_VIEW_TYPE_2D;
 
+		// The table is declared as sampler2D, cubemaps and storage images keep going through binding lists
+		if (forge->bindless_table && image->sampler && image->view_type == VK_IMAGE_VIEW_TYPE_2D && (image->description.usage & VK_IMAGE_USAGE_SAMPLED_BIT))
+		{
+			image->bindless_index = forge_bindless_table_image_add(forge, forge->bindless_table, image);
+		}
+
 		return true;
 	}
 
 	static void
 	_forge_image_free(Forge* forge, ForgeImage* image)
 	{
+		if (image->bindless_index != FORGE_BINDLESS_INVALID_INDEX)
+		{
+			forge_bindless_table_image_remove(forge, forge->bindless_table, image->bindless_index);
+		}
+
 		if (image->sampler)
 		{
-			forge_deletion_queue_push(forge, forge->deletion_queue, image->sampler);
+			forge_sampler_release(forge, forge->sampler_cache, image->sampler);
 		}
 
 		if (image->shader_view)
@@ -163,14 +166,14 @@ namespace forge
 			forge_deletion_queue_push(forge, forge->deletion_queue, image->render_target_view);
 		}
 
-		if (image->memory)
+		if (image->handle)
 		{
-			forge_deletion_queue_push(forge, forge->deletion_queue, image->memory);
+			forge_deletion_queue_push(forge, forge->deletion_queue, image->handle);
 		}
 
-		if (image->handle)
+		if (image->memory.memory)
 		{
-			forge_deletion_queue_push(forge, forge->deletion_queue, image->handle);
+			forge_memory_allocator_free(forge, forge->memory_allocator, image->memory);
 		}
 	}
 
@@ -205,82 +208,64 @@ namespace forge
 	static void
 	_forge_image_write(Forge* forge, ForgeImage* image, uint32_t layer, uint32_t size, void* data)
 	{
-		VkResult res;
-
 		auto remaining_size = size;
-		auto staging_buffer = forge->staging_buffer;
-		auto staging_command_buffer = forge->staging_command_buffer;
+		auto staging = forge->staging;
 		auto format_size = _forge_format_size(image->description.format);
 		auto row_size = image->description.extent.width * format_size;
 		auto count = 0u;
 
-		VkCommandBufferBeginInfo begin_info{};
-		begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-		res = vkBeginCommandBuffer(staging_command_buffer, &begin_info);
-		VK_RES_CHECK(res);
+		// Copies are split on whole rows so every chunk must fit in a single staging region
+		auto max_write_size = staging->region_size - (staging->region_size % row_size);
+		if (max_write_size == 0u)
+		{
+			log_error("A single row of '{}' ('{}' bytes) doesn't fit in a staging region ('{}' bytes)", image->description.name, row_size, staging->region_size);
+			return;
+		}
 
 		VkImageMemoryBarrier barrier{};
 		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-		barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
 		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
 		barrier.image = image->handle;
 		barrier.subresourceRange.aspectMask = image->aspect;
 		barrier.subresourceRange.baseMipLevel = 0u;
-		barrier.subresourceRange.levelCount = 1u;
+		barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
 		barrier.subresourceRange.baseArrayLayer = layer;
 		barrier.subresourceRange.layerCount = 1u;
-		vkCmdPipelineBarrier(
-			staging_command_buffer,
-			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
-			VK_PIPELINE_STAGE_TRANSFER_BIT,
-			0u,
-			0u, nullptr,
-			0u, nullptr,
-			1u, &barrier
-		);
+
+		VkCommandBuffer recording_command_buffer = VK_NULL_HANDLE;
 
 		while (remaining_size > 0)
 		{
-			auto write_size = remaining_size;
+			auto write_size = std::min(remaining_size, max_write_size);
 			auto written_size = size - remaining_size;
-			bool reset = (staging_buffer->cursor + write_size > staging_buffer->description.size) || (staging_buffer->cursor % format_size != 0);
-
-			if (reset)
-			{
-				staging_buffer->cursor = 0;
-
-				vkEndCommandBuffer(staging_command_buffer);
 
-				// Submit pending transfer operations
-				VkSubmitInfo submit_info{};
-				submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-				submit_info.commandBufferCount = 1;
-				submit_info.pCommandBuffers = &staging_command_buffer;
-				res = vkQueueSubmit(forge->queue, 1u, &submit_info, VK_NULL_HANDLE);
-				VK_RES_CHECK(res);
+			uint32_t staging_offset = 0u;
+			auto command_buffer = forge_staging_reserve(forge, staging, write_size, format_size * 4u, &staging_offset);
 
-				// Wait for the queue to ensure all transfers are complete
-				// TODO: We shouldn't halt the whole queue for this
-				vkQueueWaitIdle(forge->queue);
-
-				res = vkBeginCommandBuffer(staging_command_buffer, &begin_info);
-				VK_RES_CHECK(res);
-			}
-
-			if (staging_buffer->cursor + write_size > staging_buffer->description.size)
+			// Large writes can span several staging regions, each of their command buffers needs its own barrier
+			if (command_buffer != recording_command_buffer)
 			{
-				write_size = staging_buffer->description.size;
+				bool first = recording_command_buffer == VK_NULL_HANDLE;
+				barrier.srcAccessMask = first ? VK_ACCESS_MEMORY_WRITE_BIT : VK_ACCESS_TRANSFER_WRITE_BIT;
+				barrier.oldLayout = first ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+				vkCmdPipelineBarrier(
+					command_buffer,
+					VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+					VK_PIPELINE_STAGE_TRANSFER_BIT,
+					0u,
+					0u, nullptr,
+					0u, nullptr,
+					1u, &barrier
+				);
+
+				recording_command_buffer = command_buffer;
 			}
 
-			write_size -= (write_size % row_size);
-
-			memcpy((char*)staging_buffer->mapped_ptr + staging_buffer->cursor, (char*)data + written_size, write_size);
+			memcpy((char*)staging->buffer->mapped_ptr + staging_offset, (char*)data + written_size, write_size);
 
 			VkBufferImageCopy copy_info{};
-			copy_info.bufferOffset = staging_buffer->cursor;
+			copy_info.bufferOffset = staging_offset;
 			copy_info.imageSubresource.aspectMask = image->aspect;
 			copy_info.imageSubresource.mipLevel = 0u;
 			copy_info.imageSubresource.baseArrayLayer = layer;
@@ -290,9 +275,8 @@ namespace forge
 			copy_info.imageExtent.width = image->description.extent.width;
 			copy_info.imageExtent.height = std::max(write_size / row_size, 1u);
 			copy_info.imageExtent.depth = 1u;
-			vkCmdCopyBufferToImage(staging_command_buffer, staging_buffer->handle, image->handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1u, &copy_info);
+			vkCmdCopyBufferToImage(command_buffer, staging->buffer->handle, image->handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1u, &copy_info);
 
-			staging_buffer->cursor += write_size;
 			remaining_size -= write_size;
 			count += 1u;
 		}
@@ -302,7 +286,7 @@ namespace forge
 		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
 		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		vkCmdPipelineBarrier(
-			staging_command_buffer,
+			recording_command_buffer,
 			VK_PIPELINE_STAGE_TRANSFER_BIT,
 			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
 			0u,
@@ -311,10 +295,12 @@ namespace forge
 			1u, &barrier
 		);
 
-		vkEndCommandBuffer(forge->staging_command_buffer);
+		// Uploads are submitted ahead of the frames that consume them so the layout can be tracked right away
+		image->layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		image->upload_signal = staging->timeline_next_signal;
 
-		log_info("Writing operation to '{}' was done using '{}' copy operations (Staging buffer size: {}, Total data size: {})",
-			image->description.name, count, staging_buffer->description.size, size);
+		log_info("Writing operation to '{}' was done using '{}' copy operations (Staging region size: {}, Total data size: {})",
+			image->description.name, count, staging->region_size, size);
 	}
 
 	static void
@@ -423,8 +409,9 @@ namespace forge
 	ForgeImage*
 	forge_image_new(Forge* forge, ForgeImageDescription descriptrion)
 	{
-		auto image = new ForgeImage;
+		auto image = new ForgeImage();
 		image->description = descriptrion;
+		image->bindless_index = FORGE_BINDLESS_INVALID_INDEX;
 
 		if (!_forge_image_init(forge, image))
 		{
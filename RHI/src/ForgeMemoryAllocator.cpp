@@ -0,0 +1,303 @@
+#include "Forge.h"
+#include "ForgeMemoryAllocator.h"
+#include "ForgeLogger.h"
+#include "ForgeUtils.h"
+#include "ForgeDeletionQueue.h"
+
+#include <algorithm>
+
+namespace forge
+{
+	static bool
+	_forge_memory_block_range_acquire(ForgeMemoryBlock* block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize* offset)
+	{
+		auto& ranges = block->free_ranges;
+
+		for (size_t i = 0; i < ranges.size(); ++i)
+		{
+			auto range = ranges[i];
+			auto aligned_offset = _forge_align_up(range.offset, alignment);
+			auto padding = aligned_offset - range.offset;
+			if (padding + size > range.size)
+				continue;
+
+			auto tail_offset = aligned_offset + size;
+			auto tail_size = range.offset + range.size - tail_offset;
+
+			if (padding > 0)
+			{
+				// Keep the alignment padding as a free range of its own so it can be merged back later
+				ranges[i].size = padding;
+
+				if (tail_size > 0)
+				{
+					ranges.insert(ranges.begin() + i + 1, { tail_offset, tail_size });
+				}
+			}
+			else if (tail_size > 0)
+			{
+				ranges[i] = { tail_offset, tail_size };
+			}
+			else
+			{
+				ranges.erase(ranges.begin() + i);
+			}
+
+			block->used += size;
+			*offset = aligned_offset;
+
+			return true;
+		}
+
+		return false;
+	}
+
+	static void
+	_forge_memory_block_range_release(ForgeMemoryBlock* block, VkDeviceSize offset, VkDeviceSize size)
+	{
+		auto& ranges = block->free_ranges;
+
+		auto iter = std::lower_bound(ranges.begin(), ranges.end(), offset, [](const ForgeMemoryRange& range, VkDeviceSize value) {
+			return range.offset < value;
+		});
+		iter = ranges.insert(iter, { offset, size });
+
+		auto next = iter + 1;
+		if (next != ranges.end() && iter->offset + iter->size == next->offset)
+		{
+			iter->size += next->size;
+			iter = ranges.erase(next) - 1;
+		}
+
+		if (iter != ranges.begin())
+		{
+			auto prev = iter - 1;
+			if (prev->offset + prev->size == iter->offset)
+			{
+				prev->size += iter->size;
+				ranges.erase(iter);
+			}
+		}
+
+		block->used -= size;
+	}
+
+	static ForgeMemoryBlock*
+	_forge_memory_block_new(Forge* forge, ForgeMemoryPool* pool, VkDeviceSize size)
+	{
+		VkResult res;
+
+		VkMemoryAllocateInfo alloc_info{};
+		alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		alloc_info.allocationSize = size;
+		alloc_info.memoryTypeIndex = pool->memory_type_index;
+
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		res = vkAllocateMemory(forge->device, &alloc_info, nullptr, &memory);
+
+		// Not asserting here, the caller might retry with a smaller block
+		if (res != VK_SUCCESS)
+		{
+			log_warning("Failed to allocate a '{}' bytes memory block for memory type '{}', the following error code '{}' is reported",
+				size, pool->memory_type_index, _forge_result_to_str(res));
+			return nullptr;
+		}
+
+		auto block = new ForgeMemoryBlock();
+		block->memory = memory;
+		block->size = size;
+		block->used = 0u;
+		block->free_ranges.push_back({ 0u, size });
+
+		if (pool->memory_properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+		{
+			res = vkMapMemory(forge->device, block->memory, 0u, VK_WHOLE_SIZE, 0u, &block->mapped_ptr);
+			VK_RES_CHECK(res);
+		}
+
+		log_info("A '{}' bytes memory block was allocated for memory type '{}'", size, pool->memory_type_index);
+
+		return block;
+	}
+
+	static void
+	_forge_memory_block_destroy(Forge* forge, ForgeMemoryBlock* block)
+	{
+		// Freeing the memory implicitly unmaps it
+		vkFreeMemory(forge->device, block->memory, nullptr);
+		delete block;
+	}
+
+	static void
+	_forge_memory_allocator_release(Forge* forge, ForgeMemoryAllocator* allocator, const ForgeMemoryAllocation& allocation)
+	{
+		std::lock_guard<std::mutex> lock(allocator->mutex);
+
+		auto pool = allocation.pool;
+		auto block = allocation.block;
+
+		_forge_memory_block_range_release(block, allocation.offset, allocation.size);
+		--allocator->allocations_count;
+
+		// Always keep one block around per pool so create/destroy patterns don't hit the driver
+		if (block->used == 0u && pool->blocks.size() > 1)
+		{
+			pool->blocks.erase(std::find(pool->blocks.begin(), pool->blocks.end(), block));
+			_forge_memory_block_destroy(forge, block);
+			--allocator->blocks_count;
+		}
+	}
+
+	static bool
+	_forge_memory_allocator_init(Forge* forge, ForgeMemoryAllocator* allocator)
+	{
+		auto& memory_properties = forge->physical_device_memory_properties;
+
+		for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i)
+		{
+			for (uint32_t j = 0; j < FORGE_MEMORY_RESOURCE_COUNT; ++j)
+			{
+				auto& pool = allocator->pools[i][j];
+				pool.memory_type_index = i;
+				pool.memory_properties = memory_properties.memoryTypes[i].propertyFlags;
+			}
+		}
+
+		allocator->buffer_image_granularity = forge->physical_device_limits.bufferImageGranularity;
+		allocator->non_coherent_atom_size = forge->physical_device_limits.nonCoherentAtomSize;
+
+		return true;
+	}
+
+	static void
+	_forge_memory_allocator_free(Forge* forge, ForgeMemoryAllocator* allocator)
+	{
+		if (allocator->allocations_count > 0)
+		{
+			log_warning("Memory allocator is destroyed while '{}' allocations are still alive", allocator->allocations_count);
+		}
+
+		for (auto& pools : allocator->pools)
+		{
+			for (auto& pool : pools)
+			{
+				for (auto block : pool.blocks)
+				{
+					_forge_memory_block_destroy(forge, block);
+				}
+
+				pool.blocks.clear();
+			}
+		}
+	}
+
+	ForgeMemoryAllocator*
+	forge_memory_allocator_new(Forge* forge)
+	{
+		auto allocator = new ForgeMemoryAllocator();
+
+		if (_forge_memory_allocator_init(forge, allocator) == false)
+		{
+			forge_memory_allocator_destroy(forge, allocator);
+			return nullptr;
+		}
+
+		return allocator;
+	}
+
+	bool
+	forge_memory_allocator_allocate(Forge* forge, ForgeMemoryAllocator* allocator, VkMemoryRequirements requirements, VkMemoryPropertyFlags properties, FORGE_MEMORY_RESOURCE resource, ForgeMemoryAllocation* allocation)
+	{
+		auto memory_type_index = _find_memory_type(forge, requirements.memoryTypeBits, properties);
+
+		// Linear and optimal resources can safely share blocks when there's no granularity to respect
+		if (allocator->buffer_image_granularity <= 1u)
+		{
+			resource = FORGE_MEMORY_RESOURCE_LINEAR;
+		}
+
+		std::lock_guard<std::mutex> lock(allocator->mutex);
+
+		auto pool = &allocator->pools[memory_type_index][resource];
+		auto size = requirements.size;
+		auto alignment = std::max(requirements.alignment, (VkDeviceSize)1u);
+
+		// Flushing non coherent memory must happen on atom boundaries
+		bool non_coherent = (pool->memory_properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && (pool->memory_properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0;
+		if (non_coherent)
+		{
+			alignment = std::max(alignment, allocator->non_coherent_atom_size);
+			size = _forge_align_up(size, allocator->non_coherent_atom_size);
+		}
+
+		VkDeviceSize offset = 0u;
+		ForgeMemoryBlock* chosen_block = nullptr;
+
+		for (auto block : pool->blocks)
+		{
+			if (block->size - block->used < size)
+				continue;
+
+			if (_forge_memory_block_range_acquire(block, size, alignment, &offset))
+			{
+				chosen_block = block;
+				break;
+			}
+		}
+
+		if (chosen_block == nullptr)
+		{
+			chosen_block = _forge_memory_block_new(forge, pool, std::max(FORGE_MEMORY_ALLOCATOR_BLOCK_SIZE, size));
+
+			// Small heaps might not be able to fit a whole block, fall back to a dedicated one
+			if (chosen_block == nullptr && size < FORGE_MEMORY_ALLOCATOR_BLOCK_SIZE)
+			{
+				chosen_block = _forge_memory_block_new(forge, pool, size);
+			}
+
+			if (chosen_block == nullptr)
+			{
+				log_error("Failed to allocate '{}' bytes from memory type '{}'", size, memory_type_index);
+				return false;
+			}
+
+			pool->blocks.push_back(chosen_block);
+			++allocator->blocks_count;
+
+			auto acquired = _forge_memory_block_range_acquire(chosen_block, size, alignment, &offset);
+			assert(acquired);
+		}
+
+		allocation->memory = chosen_block->memory;
+		allocation->offset = offset;
+		allocation->size = size;
+		allocation->mapped_ptr = chosen_block->mapped_ptr ? (char*)chosen_block->mapped_ptr + offset : nullptr;
+		allocation->pool = pool;
+		allocation->block = chosen_block;
+
+		++allocator->allocations_count;
+
+		return true;
+	}
+
+	void
+	forge_memory_allocator_free(Forge* forge, ForgeMemoryAllocator* allocator, ForgeMemoryAllocation allocation)
+	{
+		if (allocation.memory == VK_NULL_HANDLE)
+			return;
+
+		forge_deletion_queue_push_callback(forge, forge->deletion_queue, [forge, allocator, allocation]() {
+			_forge_memory_allocator_release(forge, allocator, allocation);
+		});
+	}
+
+	void
+	forge_memory_allocator_destroy(Forge* forge, ForgeMemoryAllocator* allocator)
+	{
+		if (allocator)
+		{
+			_forge_memory_allocator_free(forge, allocator);
+			delete allocator;
+		}
+	}
+};
\ No newline at end of file
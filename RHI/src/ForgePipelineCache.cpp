@@ -0,0 +1,230 @@
+#include "Forge.h"
+#include "ForgePipelineCache.h"
+#include "ForgeLogger.h"
+#include "ForgeUtils.h"
+
+#include <vector>
+#include <fstream>
+#include <filesystem>
+
+namespace forge
+{
+	static bool
+	_forge_pipeline_cache_header_match(const ForgePipelineCacheHeader& expected, const ForgePipelineCacheHeader& header)
+	{
+		return header.magic == expected.magic &&
+			header.version == expected.version &&
+			header.vendor_id == expected.vendor_id &&
+			header.device_id == expected.device_id &&
+			header.driver_version == expected.driver_version &&
+			memcmp(header.uuid, expected.uuid, VK_UUID_SIZE) == 0;
+	}
+
+	static std::vector<uint8_t>
+	_forge_pipeline_cache_load(ForgePipelineCache* cache)
+	{
+		std::vector<uint8_t> data;
+
+		std::ifstream file(cache->path, std::ios::binary);
+		if (file.is_open() == false)
+		{
+			log_info("No pipeline cache found at '{}', pipelines will be compiled from scratch", cache->path);
+			return data;
+		}
+
+		ForgePipelineCacheHeader header {};
+		if (file.read((char*)&header, sizeof(header)).good() == false)
+		{
+			log_warning("Pipeline cache '{}' is truncated and will be discarded", cache->path);
+			return data;
+		}
+
+		if (_forge_pipeline_cache_header_match(cache->header, header) == false)
+		{
+			log_warning("Pipeline cache '{}' was created by a different device or driver and will be discarded", cache->path);
+			return data;
+		}
+
+		// The size comes from disk, a corrupted one must not turn into a huge allocation
+		std::error_code error;
+		auto file_size = std::filesystem::file_size(cache->path, error);
+		if (error || header.data_size > file_size - sizeof(header))
+		{
+			log_warning("Pipeline cache '{}' is corrupted and will be discarded", cache->path);
+			return data;
+		}
+
+		data.resize(header.data_size);
+		if (file.read((char*)data.data(), data.size()).good() == false ||
+			_forge_hash_bytes(data.data(), data.size()) != header.data_hash)
+		{
+			log_warning("Pipeline cache '{}' is corrupted and will be discarded", cache->path);
+			data.clear();
+			return data;
+		}
+
+		return data;
+	}
+
+	static bool
+	_forge_pipeline_cache_init(Forge* forge, const std::string& path, ForgePipelineCache* cache)
+	{
+		VkPhysicalDeviceProperties properties {};
+		vkGetPhysicalDeviceProperties(forge->physical_device, &properties);
+
+		cache->path = path;
+		cache->header.magic = FORGE_PIPELINE_CACHE_MAGIC;
+		cache->header.version = FORGE_PIPELINE_CACHE_VERSION;
+		cache->header.vendor_id = properties.vendorID;
+		cache->header.device_id = properties.deviceID;
+		cache->header.driver_version = properties.driverVersion;
+		memcpy(cache->header.uuid, properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+		std::vector<uint8_t> data;
+		if (cache->path.empty() == false)
+		{
+			data = _forge_pipeline_cache_load(cache);
+		}
+
+		VkPipelineCacheCreateInfo cache_info {};
+		cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		cache_info.initialDataSize = data.size();
+		cache_info.pInitialData = data.empty() ? nullptr : data.data();
+		auto res = vkCreatePipelineCache(forge->device, &cache_info, nullptr, &cache->handle);
+
+		// The driver might still refuse a blob that passed our checks, start from an empty cache instead of failing
+		if (res != VK_SUCCESS && data.empty() == false)
+		{
+			log_warning("Driver rejected pipeline cache '{}', the following error code '{}' is reported", cache->path, _forge_result_to_str(res));
+
+			data.clear();
+			cache_info.initialDataSize = 0u;
+			cache_info.pInitialData = nullptr;
+			res = vkCreatePipelineCache(forge->device, &cache_info, nullptr, &cache->handle);
+		}
+		VK_RES_CHECK(res);
+
+		if (res != VK_SUCCESS)
+		{
+			log_error("Failed to create the pipeline cache, the following error code '{}' is reported", _forge_result_to_str(res));
+			return false;
+		}
+
+		_forge_debug_obj_name_set(forge, (uint64_t)cache->handle, VK_OBJECT_TYPE_PIPELINE_CACHE, "Forge pipeline cache");
+
+		cache->saved_size = data.size();
+
+		if (data.empty() == false)
+		{
+			log_info("A '{}' bytes pipeline cache was loaded from '{}'", data.size(), cache->path);
+		}
+
+		return true;
+	}
+
+	static void
+	_forge_pipeline_cache_free(Forge* forge, ForgePipelineCache* cache)
+	{
+		if (cache->handle)
+		{
+			forge_pipeline_cache_flush(forge, cache);
+
+			// Pipelines don't reference the cache they were created from so there's no need to defer this
+			vkDestroyPipelineCache(forge->device, cache->handle, nullptr);
+		}
+	}
+
+	ForgePipelineCache*
+	forge_pipeline_cache_new(Forge* forge, const std::string& path)
+	{
+		auto cache = new ForgePipelineCache();
+
+		if (_forge_pipeline_cache_init(forge, path, cache) == false)
+		{
+			forge_pipeline_cache_destroy(forge, cache);
+			return nullptr;
+		}
+
+		return cache;
+	}
+
+	bool
+	forge_pipeline_cache_flush(Forge* forge, ForgePipelineCache* cache)
+	{
+		VkResult res;
+
+		if (cache->path.empty())
+			return true;
+
+		size_t size = 0u;
+		res = vkGetPipelineCacheData(forge->device, cache->handle, &size, nullptr);
+		VK_RES_CHECK(res);
+
+		// Caches only grow, an unchanged size means nothing new was compiled
+		if (res != VK_SUCCESS || size == cache->saved_size)
+			return res == VK_SUCCESS;
+
+		std::vector<uint8_t> data(size);
+		res = vkGetPipelineCacheData(forge->device, cache->handle, &size, data.data());
+		VK_RES_CHECK(res);
+
+		if (res != VK_SUCCESS)
+		{
+			log_error("Failed to read back the pipeline cache data, the following error code '{}' is reported", _forge_result_to_str(res));
+			return false;
+		}
+
+		auto header = cache->header;
+		header.data_size = size;
+		header.data_hash = _forge_hash_bytes(data.data(), size);
+
+		std::error_code error;
+		auto path = std::filesystem::path(cache->path);
+		auto temp_path = path;
+		temp_path += ".tmp";
+
+		if (path.has_parent_path())
+		{
+			std::filesystem::create_directories(path.parent_path(), error);
+		}
+
+		{
+			std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+			file.write((const char*)&header, sizeof(header));
+			file.write((const char*)data.data(), size);
+
+			if (file.good() == false)
+			{
+				log_error("Failed to write the pipeline cache to '{}'", temp_path.string());
+				file.close();
+				std::filesystem::remove(temp_path, error);
+				return false;
+			}
+		}
+
+		// A crash mid-write must never leave a half written cache behind, the rename replaces the old file in one step
+		std::filesystem::rename(temp_path, path, error);
+		if (error)
+		{
+			log_error("Failed to replace pipeline cache '{}', the following error '{}' is reported", cache->path, error.message());
+			std::filesystem::remove(temp_path, error);
+			return false;
+		}
+
+		cache->saved_size = size;
+
+		log_info("A '{}' bytes pipeline cache was written to '{}'", size, cache->path);
+
+		return true;
+	}
+
+	void
+	forge_pipeline_cache_destroy(Forge* forge, ForgePipelineCache* cache)
+	{
+		if (cache)
+		{
+			_forge_pipeline_cache_free(forge, cache);
+			delete cache;
+		}
+	}
+};
\ No newline at end of file
@@ -6,25 +6,38 @@
 
 namespace forge
 {
+	// Load and store ops don't affect render pass compatibility, only the attachments' formats and sample counts do
+	static uint64_t
+	_forge_render_pass_compatibility_hash(const ForgeRenderPassDescription& description)
+	{
+		uint64_t seed = 0u;
+
+		for (uint32_t i = 0; i < FORGE_RENDER_PASS_MAX_ATTACHMENTS; ++i)
+		{
+			auto image = description.colors[i].image;
+			_forge_hash_combine(seed, image ? image->description.format : VK_FORMAT_UNDEFINED);
+		}
+
+		auto depth = description.depth.image;
+		_forge_hash_combine(seed, depth ? depth->description.format : VK_FORMAT_UNDEFINED);
+		_forge_hash_combine(seed, VK_SAMPLE_COUNT_1_BIT);
+
+		return seed;
+	}
+
 	static bool
-	_forge_render_pass_init(Forge* forge, ForgeRenderPass* render_pass)
+	_forge_render_pass_handle_init(Forge* forge, const ForgeRenderPassDescription& render_pass_desc, VkRenderPass* handle)
 	{
 		VkResult res;
 
-		auto& render_pass_desc = render_pass->description;
-
 		VkAttachmentReference color_attachments_reference[FORGE_RENDER_PASS_MAX_ATTACHMENTS] = {};
 		uint32_t color_attachments_count = 0u;
 
 		VkAttachmentReference depth_attachment_reference = {};
 
 		VkAttachmentDescription attachments[FORGE_RENDER_PASS_MAX_ATTACHMENTS + 1] = {};
-		VkImageView attachment_views[FORGE_RENDER_PASS_MAX_ATTACHMENTS + 1] = {};
 		uint32_t attachments_count = 0;
 
-		uint32_t width = 0u;
-		uint32_t height = 0u;
-
 		for (uint32_t i = 0; i < FORGE_RENDER_PASS_MAX_ATTACHMENTS; ++i)
 		{
 			auto& color_attachment_desc = render_pass_desc.colors[i];
@@ -45,11 +58,6 @@ namespace forge
 			color_attachment_reference.attachment = i;
 			color_attachment_reference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
-			attachment_views[i] = color_attachment_desc.image->render_target_view;
-
-			width = color_attachment_desc.image->description.extent.width;
-			height = color_attachment_desc.image->description.extent.height;
-
 			attachments_count++;
 		}
 		color_attachments_count = attachments_count;
@@ -70,11 +78,6 @@ namespace forge
 			depth_attachment_reference.attachment = attachments_count;
 			depth_attachment_reference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
-			attachment_views[attachments_count] = render_pass_desc.depth.image->render_target_view;
-
-			width = depth_attachment_desc.image->description.extent.width;
-			height = depth_attachment_desc.image->description.extent.height;
-
 			attachments_count++;
 		}
 
@@ -118,7 +121,7 @@ namespace forge
 		render_pass_info.pSubpasses = &subpass_description;
 		render_pass_info.dependencyCount = 2u;
 		render_pass_info.pDependencies = subpass_dependency;
-		res = vkCreateRenderPass(forge->device, &render_pass_info, nullptr, &render_pass->handle);
+		res = vkCreateRenderPass(forge->device, &render_pass_info, nullptr, handle);
 		VK_RES_CHECK(res);
 
 		if (res != VK_SUCCESS)
@@ -127,6 +130,51 @@ namespace forge
 			return false;
 		}
 
+		return true;
+	}
+
+	static bool
+	_forge_render_pass_init(Forge* forge, ForgeRenderPass* render_pass)
+	{
+		VkResult res;
+
+		auto& render_pass_desc = render_pass->description;
+
+		if (_forge_render_pass_handle_init(forge, render_pass_desc, &render_pass->handle) == false)
+		{
+			return false;
+		}
+
+		VkImageView attachment_views[FORGE_RENDER_PASS_MAX_ATTACHMENTS + 1] = {};
+		uint32_t attachments_count = 0;
+
+		uint32_t width = 0u;
+		uint32_t height = 0u;
+
+		for (uint32_t i = 0; i < FORGE_RENDER_PASS_MAX_ATTACHMENTS; ++i)
+		{
+			auto& color_attachment_desc = render_pass_desc.colors[i];
+			if (color_attachment_desc.image == nullptr)
+				continue;
+
+			attachment_views[i] = color_attachment_desc.image->render_target_view;
+
+			width = color_attachment_desc.image->description.extent.width;
+			height = color_attachment_desc.image->description.extent.height;
+
+			attachments_count++;
+		}
+
+		if (render_pass_desc.depth.image != nullptr)
+		{
+			attachment_views[attachments_count] = render_pass_desc.depth.image->render_target_view;
+
+			width = render_pass_desc.depth.image->description.extent.width;
+			height = render_pass_desc.depth.image->description.extent.height;
+
+			attachments_count++;
+		}
+
 		VkFramebufferCreateInfo framebuffer_info {};
 		framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
 		framebuffer_info.renderPass = render_pass->handle;
@@ -146,6 +194,7 @@ namespace forge
 
 		render_pass->width = width;
 		render_pass->height = height;
+		render_pass->compatibility_hash = _forge_render_pass_compatibility_hash(render_pass_desc);
 
 		return true;
 	}
@@ -164,6 +213,18 @@ namespace forge
 		}
 	}
 
+	VkRenderPass
+	forge_render_pass_compatible_new(Forge* forge, ForgeRenderPass* render_pass)
+	{
+		VkRenderPass handle = VK_NULL_HANDLE;
+		if (_forge_render_pass_handle_init(forge, render_pass->description, &handle) == false)
+		{
+			return VK_NULL_HANDLE;
+		}
+
+		return handle;
+	}
+
 	ForgeRenderPass*
 	forge_render_pass_new(Forge* forge, ForgeRenderPassDescription description)
 	{
@@ -238,7 +299,7 @@ namespace forge
 	}
 
 	void
-	forge_render_pass_begin(Forge* forge, VkCommandBuffer command_buffer, ForgeRenderPass* render_pass)
+	forge_render_pass_begin(Forge* forge, VkCommandBuffer command_buffer, ForgeRenderPass* render_pass, VkSubpassContents contents)
 	{
 		auto& render_pass_desc = render_pass->description;
 		auto& attachments = render_pass_desc.colors;
@@ -278,8 +339,18 @@ namespace forge
 		render_pass_begin_info.renderArea.extent = {render_pass->width, render_pass->height};
 		render_pass_begin_info.clearValueCount = attachments_count;
 		render_pass_begin_info.pClearValues = clear_values;
-		vkCmdBeginRenderPass(command_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+		vkCmdBeginRenderPass(command_buffer, &render_pass_begin_info, contents);
 
+		// Only vkCmdExecuteCommands is allowed in a pass that was begun with secondary contents
+		if (contents == VK_SUBPASS_CONTENTS_INLINE)
+		{
+			forge_render_pass_viewport_set(forge, command_buffer, render_pass);
+		}
+	}
+
+	void
+	forge_render_pass_viewport_set(Forge* forge, VkCommandBuffer command_buffer, ForgeRenderPass* render_pass)
+	{
 		VkViewport viewport {};
 		viewport.width = (float)render_pass->width;
 		viewport.height = (float)render_pass->height;
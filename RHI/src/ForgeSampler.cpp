@@ -0,0 +1,183 @@
+#include "Forge.h"
+#include "ForgeSampler.h"
+#include "ForgeLogger.h"
+#include "ForgeUtils.h"
+#include "ForgeDeletionQueue.h"
+
+#include <algorithm>
+
+namespace forge
+{
+	static bool
+	_forge_sampler_description_equal(const ForgeSamplerDescription& a, const ForgeSamplerDescription& b)
+	{
+		return a.mag_filter == b.mag_filter &&
+			a.min_filter == b.min_filter &&
+			a.mipmap_mode == b.mipmap_mode &&
+			a.address_mode_u == b.address_mode_u &&
+			a.address_mode_v == b.address_mode_v &&
+			a.address_mode_w == b.address_mode_w &&
+			a.border_color == b.border_color &&
+			a.max_anisotropy == b.max_anisotropy &&
+			a.compare == b.compare &&
+			a.compare_op == b.compare_op;
+	}
+
+	static uint64_t
+	_forge_sampler_description_hash(Forge* forge, ForgeSamplerDescription& description)
+	{
+		// Normalize what the device ignores so equivalent descriptions share a sampler
+		if (forge->physical_device_features.samplerAnisotropy == VK_FALSE || description.max_anisotropy <= 1.0f)
+		{
+			description.max_anisotropy = 1.0f;
+		}
+		description.max_anisotropy = std::min(description.max_anisotropy, forge->physical_device_limits.maxSamplerAnisotropy);
+
+		if (description.compare == false)
+		{
+			description.compare_op = VK_COMPARE_OP_NEVER;
+		}
+
+		uint64_t seed = 0u;
+		_forge_hash_combine(seed, description.mag_filter);
+		_forge_hash_combine(seed, description.min_filter);
+		_forge_hash_combine(seed, description.mipmap_mode);
+		_forge_hash_combine(seed, description.address_mode_u);
+		_forge_hash_combine(seed, description.address_mode_v);
+		_forge_hash_combine(seed, description.address_mode_w);
+		_forge_hash_combine(seed, description.border_color);
+		_forge_hash_combine(seed, description.max_anisotropy);
+		_forge_hash_combine(seed, description.compare);
+		_forge_hash_combine(seed, description.compare_op);
+
+		return seed;
+	}
+
+	static bool
+	_forge_sampler_init(Forge* forge, ForgeSampler* sampler)
+	{
+		auto& description = sampler->description;
+
+		VkSamplerCreateInfo sampler_info{};
+		sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		sampler_info.magFilter = description.mag_filter;
+		sampler_info.minFilter = description.min_filter;
+		sampler_info.mipmapMode = description.mipmap_mode;
+		sampler_info.addressModeU = description.address_mode_u;
+		sampler_info.addressModeV = description.address_mode_v;
+		sampler_info.addressModeW = description.address_mode_w;
+		sampler_info.mipLodBias = 0.0f;
+		sampler_info.anisotropyEnable = description.max_anisotropy > 1.0f ? VK_TRUE : VK_FALSE;
+		sampler_info.maxAnisotropy = description.max_anisotropy;
+		sampler_info.compareEnable = description.compare ? VK_TRUE : VK_FALSE;
+		sampler_info.compareOp = description.compare_op;
+		sampler_info.minLod = 0.0f;
+		sampler_info.maxLod = VK_LOD_CLAMP_NONE;
+		sampler_info.borderColor = description.border_color;
+		sampler_info.unnormalizedCoordinates = VK_FALSE;
+		auto res = vkCreateSampler(forge->device, &sampler_info, nullptr, &sampler->handle);
+		VK_RES_CHECK(res);
+
+		if (res != VK_SUCCESS)
+		{
+			log_error("Failed to create a sampler, the following error code '{}' is reported", _forge_result_to_str(res));
+			return false;
+		}
+
+		return true;
+	}
+
+	static void
+	_forge_sampler_cache_free(Forge* forge, ForgeSamplerCache* cache)
+	{
+		if (cache->samplers.empty() == false)
+		{
+			log_warning("Sampler cache is destroyed while '{}' samplers are still referenced", cache->samplers.size());
+		}
+
+		// The deletion queue is already flushed by now
+		for (auto& [hash, sampler] : cache->samplers)
+		{
+			vkDestroySampler(forge->device, sampler->handle, nullptr);
+			delete sampler;
+		}
+
+		cache->samplers.clear();
+	}
+
+	ForgeSamplerCache*
+	forge_sampler_cache_new(Forge* forge)
+	{
+		return new ForgeSamplerCache();
+	}
+
+	ForgeSampler*
+	forge_sampler_acquire(Forge* forge, ForgeSamplerCache* cache, const ForgeSamplerDescription& description)
+	{
+		auto normalized = description;
+		auto hash = _forge_sampler_description_hash(forge, normalized);
+
+		std::lock_guard<std::mutex> lock(cache->mutex);
+
+		auto [begin, end] = cache->samplers.equal_range(hash);
+		for (auto iter = begin; iter != end; ++iter)
+		{
+			if (_forge_sampler_description_equal(iter->second->description, normalized))
+			{
+				++iter->second->references;
+				return iter->second;
+			}
+		}
+
+		auto sampler = new ForgeSampler();
+		sampler->description = normalized;
+		sampler->hash = hash;
+		sampler->references = 1u;
+
+		if (_forge_sampler_init(forge, sampler) == false)
+		{
+			delete sampler;
+			return nullptr;
+		}
+
+		cache->samplers.emplace(hash, sampler);
+
+		return sampler;
+	}
+
+	void
+	forge_sampler_release(Forge* forge, ForgeSamplerCache* cache, ForgeSampler* sampler)
+	{
+		if (sampler == nullptr)
+			return;
+
+		std::lock_guard<std::mutex> lock(cache->mutex);
+
+		assert(sampler->references > 0u);
+		if (--sampler->references > 0u)
+			return;
+
+		auto [begin, end] = cache->samplers.equal_range(sampler->hash);
+		for (auto iter = begin; iter != end; ++iter)
+		{
+			if (iter->second == sampler)
+			{
+				cache->samplers.erase(iter);
+				break;
+			}
+		}
+
+		forge_deletion_queue_push(forge, forge->deletion_queue, sampler->handle);
+		delete sampler;
+	}
+
+	void
+	forge_sampler_cache_destroy(Forge* forge, ForgeSamplerCache* cache)
+	{
+		if (cache)
+		{
+			_forge_sampler_cache_free(forge, cache);
+			delete cache;
+		}
+	}
+};
\ No newline at end of file
@@ -4,48 +4,20 @@
 #include "ForgeUtils.h"
 #include "ForgeBindingList.h"
 #include "ForgeDeletionQueue.h"
+#include "ForgeShaderCache.h"
+#include "ForgePipelineCache.h"
+#include "ForgeBindless.h"
+#include "ForgeWorkerPool.h"
+#include "ForgeShaderReflection.h"
+#include "ForgeShaderArchive.h"
 
 #include <vector>
+#include <algorithm>
+#include <thread>
 #include <assert.h>
 
-#include <spirv-headers/spirv.hpp>
-#include <spirv_cross/spirv_cross.hpp>
-#include <spirv_cross/spirv_common.hpp>
-
-using namespace spirv_cross;
-
 namespace forge
 {
-	static VkFormat
-	_forge_spirv_type_vk_format(SPIRType type)
-	{
-		if (type.basetype == SPIRType::BaseType::Float)
-		{
-			if (type.vecsize == 1)
-			{
-				return VK_FORMAT_R32_SFLOAT;
-			}
-			else if (type.vecsize == 2)
-			{
-				return VK_FORMAT_R32G32_SFLOAT;
-			}
-			else if (type.vecsize == 3)
-			{
-				return VK_FORMAT_R32G32B32_SFLOAT;
-			}
-			else if (type.vecsize == 4)
-			{
-				return VK_FORMAT_R32G32B32A32_SFLOAT;
-			}
-			else
-			{
-				assert(false); // unreachable
-			}
-		}
-
-		return VK_FORMAT_R8G8B8A8_UNORM;
-	}
-
 	static VkShaderStageFlagBits
 	_forge_shader_stage_vk_stage(FORGE_SHADER_STAGE stage)
 	{
@@ -53,6 +25,7 @@ namespace forge
 		{
 		case FORGE_SHADER_STAGE_VERTEX:	return VK_SHADER_STAGE_VERTEX_BIT;
 		case FORGE_SHADER_STAGE_FRAGMENT:	return VK_SHADER_STAGE_FRAGMENT_BIT;
+		case FORGE_SHADER_STAGE_COMPUTE:	return VK_SHADER_STAGE_COMPUTE_BIT;
 		default:
 			assert(false);
 			break;
@@ -61,14 +34,26 @@ namespace forge
 		return (VkShaderStageFlagBits)0u;
 	}
 
-	bool
-	_forge_shader_pipeline_init(Forge* forge, ForgeShader* shader, VkRenderPass pass)
+	static void
+	_forge_shader_specialization_info(ForgeShader* shader, VkSpecializationInfo* info)
+	{
+		info->mapEntryCount = (uint32_t)shader->specialization_entries.size();
+		info->pMapEntries = shader->specialization_entries.data();
+		info->dataSize = shader->specialization_data.size() * sizeof(uint32_t);
+		info->pData = shader->specialization_data.data();
+	}
+
+	static bool
+	_forge_shader_pipeline_init(Forge* forge, ForgeShader* shader, VkRenderPass pass, VkPipeline* pipeline)
 	{
 		VkResult res;
 
 		const auto& pipeline_description = shader->pipeline_description;
 		const auto& shader_description = shader->description;
 
+		VkSpecializationInfo specialization_info{};
+		_forge_shader_specialization_info(shader, &specialization_info);
+
 		uint32_t shader_stage_count = 0;
 		VkPipelineShaderStageCreateInfo shader_stage_create_infos[FORGE_SHADER_STAGE_COUNT]{};
 		for (uint32_t i = 0; i < FORGE_SHADER_STAGE_COUNT; ++i)
@@ -81,6 +66,7 @@ namespace forge
 			shader_stage_info.stage = _forge_shader_stage_vk_stage(static_cast<FORGE_SHADER_STAGE>(i));
 			shader_stage_info.module = shader->modules[i];
 			shader_stage_info.pName = "main";
+			shader_stage_info.pSpecializationInfo = specialization_info.mapEntryCount ? &specialization_info : nullptr;
 
 			++shader_stage_count;
 		}
@@ -90,7 +76,7 @@ namespace forge
 		for (uint32_t i = 0; i < FORGE_SHADER_MAX_INPUT_ATTRIBUTES; ++i)
 		{
 			auto& attribute_description = shader_description.attributes[i];
-			if (attribute_description.name.empty() == true)
+			if (attribute_description.format == VK_FORMAT_UNDEFINED)
 				continue;
 
 			auto& attribute = attributes[attributes_count];
@@ -207,7 +193,7 @@ namespace forge
 		pipeline_create_info.layout = shader->pipeline_layout;
 		pipeline_create_info.renderPass = pass;
 		pipeline_create_info.subpass = 0;
-		res = vkCreateGraphicsPipelines(forge->device, VK_NULL_HANDLE, 1, &pipeline_create_info, nullptr, &shader->pipeline);
+		res = vkCreateGraphicsPipelines(forge->device, forge->pipeline_cache->handle, 1, &pipeline_create_info, nullptr, pipeline);
 		VK_RES_CHECK(res);
 
 		if (res != VK_SUCCESS) {
@@ -215,9 +201,36 @@ namespace forge
 			return false;
 		}
 
-		_forge_debug_obj_name_set(forge, (uint64_t)shader->pipeline, VK_OBJECT_TYPE_PIPELINE, shader->description.name.c_str());
+		_forge_debug_obj_name_set(forge, (uint64_t)*pipeline, VK_OBJECT_TYPE_PIPELINE, shader->description.name.c_str());
+
+		return true;
+	}
+
+	static bool
+	_forge_shader_compute_pipeline_init(Forge* forge, ForgeShader* shader)
+	{
+		VkResult res;
+
+		VkSpecializationInfo specialization_info{};
+		_forge_shader_specialization_info(shader, &specialization_info);
 
-		shader->active_pass = pass;
+		VkComputePipelineCreateInfo pipeline_create_info {};
+		pipeline_create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipeline_create_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		pipeline_create_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		pipeline_create_info.stage.module = shader->modules[FORGE_SHADER_STAGE_COMPUTE];
+		pipeline_create_info.stage.pName = "main";
+		pipeline_create_info.stage.pSpecializationInfo = specialization_info.mapEntryCount ? &specialization_info : nullptr;
+		pipeline_create_info.layout = shader->pipeline_layout;
+		res = vkCreateComputePipelines(forge->device, forge->pipeline_cache->handle, 1, &pipeline_create_info, nullptr, &shader->pipeline);
+		VK_RES_CHECK(res);
+
+		if (res != VK_SUCCESS) {
+			log_error("Failed to initialize compute pipeline");
+			return false;
+		}
+
+		_forge_debug_obj_name_set(forge, (uint64_t)shader->pipeline, VK_OBJECT_TYPE_PIPELINE, shader->description.name.c_str());
 
 		return true;
 	}
@@ -227,10 +240,37 @@ namespace forge
 	{
 		VkResult res;
 
+		VkDescriptorSetLayout set_layouts[FORGE_SHADER_MAX_SETS] = {};
+		for (uint32_t i = 0; i < shader->sets_count; ++i)
+		{
+			set_layouts[i] = shader->descriptor_set_layouts[i];
+		}
+
+		if (shader->bindless)
+		{
+			set_layouts[FORGE_BINDLESS_SET] = forge->bindless_table->layout;
+		}
+
+		auto& push_constants = shader->description.push_constants;
+
+		VkPushConstantRange push_constant_range {};
+		push_constant_range.stageFlags = push_constants.stages;
+		push_constant_range.offset = 0u;
+		push_constant_range.size = push_constants.size;
+
+		if (push_constants.size > forge->physical_device_limits.maxPushConstantsSize)
+		{
+			log_error("The push constant block '{}' of the shader '{}' is '{}' bytes, the device only supports '{}'",
+				push_constants.name, shader->description.name, push_constants.size, forge->physical_device_limits.maxPushConstantsSize);
+			return false;
+		}
+
 		VkPipelineLayoutCreateInfo pipeline_layout_info = {};
 		pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipeline_layout_info.setLayoutCount = 1;
-		pipeline_layout_info.pSetLayouts = &shader->descriptor_set_layout;
+		pipeline_layout_info.setLayoutCount = shader->sets_count;
+		pipeline_layout_info.pSetLayouts = set_layouts;
+		pipeline_layout_info.pushConstantRangeCount = push_constants.stages != 0u ? 1u : 0u;
+		pipeline_layout_info.pPushConstantRanges = &push_constant_range;
 		res = vkCreatePipelineLayout(forge->device, &pipeline_layout_info, nullptr, &shader->pipeline_layout);
 		VK_RES_CHECK(res);
 
@@ -248,177 +288,383 @@ namespace forge
 	static bool
 	_forge_shader_descriptor_set_layout_init(Forge* forge, ForgeShader* shader)
 	{
-		uint32_t count = 0;
-		VkDescriptorSetLayoutBinding bindings[FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS + FORGE_MAX_IMAGE_BINDINGS] = {};
+		uint32_t counts[FORGE_SHADER_MAX_SETS] = {};
+		VkDescriptorSetLayoutBinding bindings[FORGE_SHADER_MAX_SETS][FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS + FORGE_MAX_IMAGE_BINDINGS + FORGE_MAX_STORAGE_BUFFER_BINDINGS] = {};
 
 		for (uint32_t i = 0; i < FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS; ++i)
 		{
 			auto uniforms = shader->description.uniforms;
-			if (uniforms[i].name.empty() == true)
+			if (uniforms[i].stages == 0u)
 				continue;
 
-			bindings[count].binding = i;
-			bindings[count].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-			bindings[count].descriptorCount = 1u;
-			bindings[count].stageFlags = uniforms[i].stages;
-
-			++count;
+			auto& binding = bindings[uniforms[i].set][counts[uniforms[i].set]++];
+			binding.binding = i;
+			binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+			binding.descriptorCount = 1u;
+			binding.stageFlags = uniforms[i].stages;
 		}
 
 		for (uint32_t i = 0; i < FORGE_MAX_IMAGE_BINDINGS; ++i)
 		{
 			auto images = shader->description.images;
-			if (images[i].name.empty() == true)
+			if (images[i].stages == 0u)
 				continue;
 
-			bindings[count].binding = i;
-			bindings[count].descriptorType = images[i].storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			bindings[count].descriptorCount = 1u;
-			bindings[count].stageFlags = images[i].stages;
-
-			++count;
+			auto& binding = bindings[images[i].set][counts[images[i].set]++];
+			binding.binding = i;
+			binding.descriptorType = images[i].storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			binding.descriptorCount = 1u;
+			binding.stageFlags = images[i].stages;
 		}
 
-		VkDescriptorSetLayoutCreateInfo info{};
-		info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-		info.bindingCount = count;
-		info.pBindings = bindings;
-		auto res = vkCreateDescriptorSetLayout(forge->device, &info, nullptr, &shader->descriptor_set_layout);
-		VK_RES_CHECK(res);
+		for (uint32_t i = 0; i < FORGE_MAX_STORAGE_BUFFER_BINDINGS; ++i)
+		{
+			auto storage_buffers = shader->description.storage_buffers;
+			if (storage_buffers[i].stages == 0u)
+				continue;
 
-		if (res != VK_SUCCESS)
+			auto& binding = bindings[storage_buffers[i].set][counts[storage_buffers[i].set]++];
+			binding.binding = i;
+			binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			binding.descriptorCount = 1u;
+			binding.stageFlags = storage_buffers[i].stages;
+		}
+
+		// Lower sets without resources still need a layout so the higher ones keep their indices
+		shader->sets_count = 1u;
+		for (uint32_t i = 0; i < FORGE_SHADER_MAX_SETS; ++i)
 		{
-			log_error("Failed to initialize the descriptor set layout");
-			return false;
+			shader->set_bindings[i].assign(bindings[i], bindings[i] + counts[i]);
+			if (counts[i] > 0u)
+			{
+				shader->sets_count = i + 1u;
+			}
 		}
 
-		_forge_debug_obj_name_set(forge, (uint64_t)shader->descriptor_set_layout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, shader->description.name.c_str());
+		if (shader->bindless)
+		{
+			if (forge->bindless_table == nullptr)
+			{
+				log_error("The shader '{}' samples the bindless table but bindless isn't enabled", shader->description.name);
+				return false;
+			}
 
-		return true;
-	}
+			if (counts[FORGE_BINDLESS_SET] > 0u)
+			{
+				log_error("The shader '{}' samples the bindless table, its set '{}' can't hold other resources", shader->description.name, FORGE_BINDLESS_SET);
+				return false;
+			}
 
-	static void
-	_forge_shader_images_init(Forge* forge, FORGE_SHADER_STAGE stage, ForgeShader* shader)
-	{
-		auto& module = shader->spirv[stage];
-		auto& shader_description = shader->description;
-		Compiler compiler({module.cbegin(), module.end()});
+			shader->sets_count = FORGE_BINDLESS_SET + 1u;
+		}
 
-		auto resources = compiler.get_shader_resources();
-		for (auto& spv_image : resources.sampled_images)
+		// Push descriptors can't hold dynamic uniforms, the offset is baked into every push instead
+		if (forge->description.push_descriptors && shader->bindless == false && counts[FORGE_SHADER_SET_DRAW] > 0u)
 		{
-			auto binding = compiler.get_decoration(spv_image.id, spv::DecorationBinding);
-			assert(binding < FORGE_MAX_IMAGE_BINDINGS);
+			shader->push_descriptors = true;
 
-			auto& image = shader_description.images[binding];
-			if (image.name.empty() == false)
+			for (auto& binding : shader->set_bindings[FORGE_SHADER_SET_DRAW])
 			{
-				image.stages |= _forge_shader_stage_vk_stage(stage);
-				continue;
+				if (binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+				{
+					binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+				}
 			}
-
-			auto type = compiler.get_type(spv_image.type_id);
-			image.name = spv_image.name;
-			image.stages = _forge_shader_stage_vk_stage(stage);
-			image.storage = false;
 		}
 
-		for (auto& spv_image : resources.storage_images)
+		for (uint32_t i = 0; i < shader->sets_count; ++i)
 		{
-			auto binding = compiler.get_decoration(spv_image.id, spv::DecorationBinding);
-			assert(binding < FORGE_MAX_IMAGE_BINDINGS);
+			// Owned by the bindless table
+			if (shader->bindless && i == FORGE_BINDLESS_SET)
+				continue;
 
-			auto& image = shader_description.images[binding];
-			if (image.name.empty() == false)
+			VkDescriptorSetLayoutCreateInfo info{};
+			info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			info.bindingCount = counts[i];
+			info.pBindings = shader->set_bindings[i].data();
+
+			if (shader->push_descriptors && i == FORGE_SHADER_SET_DRAW)
 			{
-				image.stages |= _forge_shader_stage_vk_stage(stage);
-				continue;
+				info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
 			}
+			auto res = vkCreateDescriptorSetLayout(forge->device, &info, nullptr, &shader->descriptor_set_layouts[i]);
+			VK_RES_CHECK(res);
 
-			auto type = compiler.get_type(spv_image.type_id);
-			image.name = spv_image.name;
-			image.stages = _forge_shader_stage_vk_stage(stage);
-			image.storage = true;
+			if (res != VK_SUCCESS)
+			{
+				log_error("Failed to initialize the descriptor set layout");
+				return false;
+			}
+
+			_forge_debug_obj_name_set(forge, (uint64_t)shader->descriptor_set_layouts[i], VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, shader->description.name.c_str());
 		}
+
+		return true;
 	}
 
-	static void
-	_forge_shader_uniform_blocks_init(Forge* forge, FORGE_SHADER_STAGE stage, ForgeShader* shader)
+	static bool
+	_forge_shader_descriptor_update_template_init(Forge* forge, ForgeShader* shader, uint32_t set_index)
 	{
-		auto& module = shader->spirv[stage];
-		auto& shader_description = shader->description;
-		Compiler compiler({module.cbegin(), module.end()});
+		auto& bindings = shader->set_bindings[set_index];
 
-		auto resources = compiler.get_shader_resources();
-		for (auto& spv_uniform : resources.uniform_buffers)
+		VkDescriptorUpdateTemplateEntry entries[FORGE_SHADER_MAX_SET_DESCRIPTORS] = {};
+		for (uint32_t i = 0; i < (uint32_t)bindings.size(); ++i)
 		{
-			auto binding = compiler.get_decoration(spv_uniform.id, spv::DecorationBinding);
-			assert(binding < FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS);
+			auto& entry = entries[i];
+			entry.dstBinding = bindings[i].binding;
+			entry.dstArrayElement = 0u;
+			entry.descriptorCount = bindings[i].descriptorCount;
+			entry.descriptorType = bindings[i].descriptorType;
+			entry.offset = i * sizeof(ForgeDescriptorPayloadEntry);
+			entry.stride = sizeof(ForgeDescriptorPayloadEntry);
+		}
 
-			auto& uniform = shader_description.uniforms[binding];
-			if (uniform.name.empty() == false)
-			{
-				uniform.stages |= _forge_shader_stage_vk_stage(stage);
-				continue;
-			}
+		VkDescriptorUpdateTemplateCreateInfo info{};
+		info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+		info.descriptorUpdateEntryCount = (uint32_t)bindings.size();
+		info.pDescriptorUpdateEntries = entries;
+		info.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+		info.descriptorSetLayout = shader->descriptor_set_layouts[set_index];
 
-			uniform.name = spv_uniform.name;
-			uniform.size = (uint32_t)compiler.get_declared_struct_size(compiler.get_type(spv_uniform.type_id));
-			uniform.stages = _forge_shader_stage_vk_stage(stage);
+		// Pushed templates are tied to the pipeline layout instead of the set layout
+		if (shader->push_descriptors && set_index == FORGE_SHADER_SET_DRAW)
+		{
+			info.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_PUSH_DESCRIPTORS_KHR;
+			info.pipelineBindPoint = shader->modules[FORGE_SHADER_STAGE_COMPUTE] ? VK_PIPELINE_BIND_POINT_COMPUTE : VK_PIPELINE_BIND_POINT_GRAPHICS;
+			info.pipelineLayout = shader->pipeline_layout;
+			info.set = set_index;
+		}
+		auto res = vkCreateDescriptorUpdateTemplate(forge->device, &info, nullptr, &shader->descriptor_update_templates[set_index]);
+		VK_RES_CHECK(res);
 
-			shader->uniforms_count++;
+		if (res != VK_SUCCESS)
+		{
+			log_error("Failed to initialize the descriptor update template");
+			return false;
 		}
+
+		_forge_debug_obj_name_set(forge, (uint64_t)shader->descriptor_update_templates[set_index], VK_OBJECT_TYPE_DESCRIPTOR_UPDATE_TEMPLATE, shader->description.name.c_str());
+
+		return true;
 	}
 
 	static bool
-	_forge_shader_description_init(Forge* forge, const char* name, const char* shader_source_code, ForgeShader* shader)
+	_forge_shader_descriptor_update_templates_init(Forge* forge, ForgeShader* shader)
 	{
-		auto& module = shader->spirv[FORGE_SHADER_STAGE_VERTEX];
-		auto& shader_description = shader->description;
-		Compiler compiler({module.cbegin(), module.end()});
+		for (uint32_t i = 0; i < shader->sets_count; ++i)
+		{
+			if (shader->set_bindings[i].empty())
+				continue;
+
+			if (_forge_shader_descriptor_update_template_init(forge, shader, i) == false)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
 
-		auto resources = compiler.get_shader_resources();
-		for (auto& input : resources.stage_inputs)
+	static void
+	_forge_shader_resource_set_check(ForgeShader* shader, const std::string& name, uint32_t set, uint32_t other_set)
+	{
+		// Binding lists address resources by binding only, two stages can't disagree on the set of one
+		if (set != other_set)
 		{
-			auto binding  = compiler.get_decoration(input.id, spv::DecorationBinding);
-			assert(binding < FORGE_SHADER_MAX_INPUT_ATTRIBUTES);
+			log_error("The resource '{}' of the shader '{}' is declared in both set '{}' and set '{}', the first one is used", name, shader->description.name, set, other_set);
+		}
+	}
 
-			auto& attribute = shader_description.attributes[binding];
-			attribute.name = input.name;
-			attribute.location = compiler.get_decoration(input.id, spv::DecorationLocation);
-			attribute.format = _forge_spirv_type_vk_format(compiler.get_type(input.type_id));
-			attribute.offset = 0u; // ??
+	static bool
+	_forge_shader_resource_binding_check(ForgeShader* shader, const ForgeShaderReflectionResource& resource, uint32_t bindings_count)
+	{
+		if (resource.set >= FORGE_SHADER_MAX_SETS || resource.binding >= bindings_count)
+		{
+			log_error("The resource '{}' of the shader '{}' uses set '{}' binding '{}', past the shader limits", resource.name, shader->description.name, resource.set, resource.binding);
+			return false;
 		}
 
-		_forge_shader_uniform_blocks_init(forge, FORGE_SHADER_STAGE_VERTEX, shader);
-		_forge_shader_uniform_blocks_init(forge, FORGE_SHADER_STAGE_FRAGMENT, shader);
+		return true;
+	}
 
-		_forge_shader_images_init(forge, FORGE_SHADER_STAGE_VERTEX, shader);
-		_forge_shader_images_init(forge, FORGE_SHADER_STAGE_FRAGMENT, shader);
+	// Merges the reflection record of one stage into the shader's description, resources used by several stages are
+	// declared once with the union of their stages
+	static bool
+	_forge_shader_reflection_apply(Forge* forge, FORGE_SHADER_STAGE stage, ForgeShader* shader)
+	{
+		auto& shader_description = shader->description;
+		auto vk_stage = _forge_shader_stage_vk_stage(stage);
 
-		shader_description.name = name;
+		for (auto& resource : shader->reflections[stage].resources)
+		{
+			switch (resource.kind)
+			{
+			case FORGE_SHADER_REFLECTION_KIND_INPUT:
+			{
+				// Stage inputs have no binding decoration, every location is fed by the vertex buffer binding of the same index
+				if (stage != FORGE_SHADER_STAGE_VERTEX)
+					break;
+
+				if (_forge_shader_resource_binding_check(shader, resource, FORGE_SHADER_MAX_INPUT_ATTRIBUTES) == false)
+					return false;
+
+				auto& attribute = shader_description.attributes[resource.binding];
+				attribute.name = resource.name;
+				attribute.location = resource.binding;
+				attribute.format = (VkFormat)resource.value;
+				attribute.offset = 0u; // ??
+				break;
+			}
+			case FORGE_SHADER_REFLECTION_KIND_UNIFORM_BUFFER:
+			{
+				if (_forge_shader_resource_binding_check(shader, resource, FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS) == false)
+					return false;
+
+				auto& uniform = shader_description.uniforms[resource.binding];
+				if (uniform.stages != 0u)
+				{
+					_forge_shader_resource_set_check(shader, uniform.name, uniform.set, resource.set);
+					uniform.stages |= vk_stage;
+					break;
+				}
+
+				uniform.name = resource.name;
+				uniform.size = resource.size;
+				uniform.set = resource.set;
+				uniform.stages = vk_stage;
+				break;
+			}
+			case FORGE_SHADER_REFLECTION_KIND_BINDLESS_TABLE:
+			{
+				// The bindless table isn't part of the shader's own layouts, it's appended to the pipeline layout instead
+				if (resource.set == FORGE_BINDLESS_SET)
+				{
+					shader->bindless = true;
+					break;
+				}
+
+				log_error("The shader '{}' declares the unsized image array '{}' outside of the bindless set", shader_description.name, resource.name);
+				return false;
+			}
+			case FORGE_SHADER_REFLECTION_KIND_SAMPLED_IMAGE:
+			case FORGE_SHADER_REFLECTION_KIND_STORAGE_IMAGE:
+			{
+				if (_forge_shader_resource_binding_check(shader, resource, FORGE_MAX_IMAGE_BINDINGS) == false)
+					return false;
+
+				auto& image = shader_description.images[resource.binding];
+				if (image.stages != 0u)
+				{
+					_forge_shader_resource_set_check(shader, image.name, image.set, resource.set);
+					image.stages |= vk_stage;
+					break;
+				}
+
+				image.name = resource.name;
+				image.set = resource.set;
+				image.stages = vk_stage;
+				image.storage = resource.kind == FORGE_SHADER_REFLECTION_KIND_STORAGE_IMAGE;
+				break;
+			}
+			case FORGE_SHADER_REFLECTION_KIND_STORAGE_BUFFER:
+			{
+				if (_forge_shader_resource_binding_check(shader, resource, FORGE_MAX_STORAGE_BUFFER_BINDINGS) == false)
+					return false;
+
+				// A block is only read only if every stage declares it readonly
+				auto readonly = resource.value != 0u;
+
+				auto& storage_buffer = shader_description.storage_buffers[resource.binding];
+				if (storage_buffer.stages != 0u)
+				{
+					_forge_shader_resource_set_check(shader, storage_buffer.name, storage_buffer.set, resource.set);
+					storage_buffer.stages |= vk_stage;
+					storage_buffer.readonly = storage_buffer.readonly && readonly;
+					break;
+				}
+
+				storage_buffer.name = resource.name;
+				storage_buffer.size = resource.size;
+				storage_buffer.set = resource.set;
+				storage_buffer.stages = vk_stage;
+				storage_buffer.readonly = readonly;
+				break;
+			}
+			case FORGE_SHADER_REFLECTION_KIND_PUSH_CONSTANTS:
+			{
+				// Stages may declare a prefix of the block, the range has to cover the largest declaration
+				auto& push_constants = shader_description.push_constants;
+				if (push_constants.stages != 0u)
+				{
+					push_constants.stages |= vk_stage;
+					push_constants.size = std::max(push_constants.size, resource.size);
+					break;
+				}
+
+				push_constants.name = resource.name;
+				push_constants.size = resource.size;
+				push_constants.stages = vk_stage;
+				break;
+			}
+			default:
+				log_error("The shader '{}' has a reflected resource '{}' of unknown kind", shader_description.name, resource.name);
+				return false;
+			}
+		}
 
 		return true;
 	}
 
 	static bool
-	_forge_shader_module_init(Forge* forge, FORGE_SHADER_STAGE stage, const char* name, const char* source, ForgeShader* shader)
+	_forge_shader_description_init(Forge* forge, const char* name, const char* shader_source_code, ForgeShader* shader)
 	{
-		shaderc::Compiler compiler;
-		shaderc::CompileOptions options;
-		options.AddMacroDefinition(stage == FORGE_SHADER_STAGE_VERTEX ? "VERTEX_SHADER" : "FRAGMENT_SHADER");
-		shaderc::SpvCompilationResult module = compiler.CompileGlslToSpv(source, (shaderc_shader_kind)stage, name, options);
+		shader->description.name = name;
+
+		return _forge_shader_reflection_apply(forge, FORGE_SHADER_STAGE_VERTEX, shader) &&
+			_forge_shader_reflection_apply(forge, FORGE_SHADER_STAGE_FRAGMENT, shader);
+	}
 
-		if (module.GetCompilationStatus() != shaderc_compilation_status_success)
+	static bool
+	_forge_compute_shader_description_init(Forge* forge, const char* name, ForgeShader* shader)
+	{
+		shader->description.name = name;
+
+		return _forge_shader_reflection_apply(forge, FORGE_SHADER_STAGE_COMPUTE, shader);
+	}
+
+	static const char*
+	_forge_shader_stage_macro(FORGE_SHADER_STAGE stage)
+	{
+		switch (stage)
 		{
-			log_error("{}", module.GetErrorMessage().c_str());
-			return false;
+		case FORGE_SHADER_STAGE_VERTEX:	return "VERTEX_SHADER";
+		case FORGE_SHADER_STAGE_FRAGMENT:	return "FRAGMENT_SHADER";
+		case FORGE_SHADER_STAGE_COMPUTE:	return "COMPUTE_SHADER";
+		default:
+			assert(false);
+			break;
 		}
 
+		return "";
+	}
+
+	static bool
+	_forge_shader_spirv_init(Forge* forge, FORGE_SHADER_STAGE stage, const char* name, const char* source, ForgeShader* shader)
+	{
+		// Keyword macros come on top of the stage one, each combination is its own cache entry
+		std::vector<std::string> macros = { _forge_shader_stage_macro(stage) };
+		macros.insert(macros.end(), shader->macros.begin(), shader->macros.end());
+
+		return forge_shader_cache_compile(forge, forge->shader_cache, (shaderc_shader_kind)stage, name, source, macros, &shader->spirv[stage], &shader->reflections[stage]);
+	}
+
+	static bool
+	_forge_shader_module_init(Forge* forge, FORGE_SHADER_STAGE stage, const uint32_t* code, size_t size, ForgeShader* shader)
+	{
 		VkShaderModuleCreateInfo info {};
 		info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		info.codeSize = (uintptr_t)module.cend() - (uintptr_t)module.cbegin();
-		info.pCode = module.cbegin();
+		info.codeSize = size;
+		info.pCode = code;
 		auto res = vkCreateShaderModule(forge->device, &info, nullptr, &shader->modules[stage]);
 		VK_RES_CHECK(res);
 
@@ -428,31 +674,79 @@ namespace forge
 			return false;
 		}
 
-		_forge_debug_obj_name_set(forge, (uint64_t)shader->modules[stage], VK_OBJECT_TYPE_SHADER_MODULE, name);
-
-		shader->spirv[stage] = std::move(module);
+		_forge_debug_obj_name_set(forge, (uint64_t)shader->modules[stage], VK_OBJECT_TYPE_SHADER_MODULE, shader->description.name.c_str());
 
 		return true;
 	}
 
+	// Compilation and reflection only touch the shader itself, they can run on any thread
 	static bool
-	_forge_shader_init(Forge* forge, ForgePipelineDescription pipeline_description, const char* name, const char* shader_source_code, ForgeShader* shader)
+	_forge_shader_compile(Forge* forge, const char* name, const char* shader_source_code, ForgeShader* shader)
 	{
-		if (_forge_shader_module_init(forge, FORGE_SHADER_STAGE_VERTEX, name, shader_source_code, shader) == false)
+		if (_forge_shader_spirv_init(forge, FORGE_SHADER_STAGE_VERTEX, name, shader_source_code, shader) == false)
 		{
 			return false;
 		}
 
-		if (_forge_shader_module_init(forge, FORGE_SHADER_STAGE_FRAGMENT, name, shader_source_code, shader) == false)
+		if (_forge_shader_spirv_init(forge, FORGE_SHADER_STAGE_FRAGMENT, name, shader_source_code, shader) == false)
 		{
 			return false;
 		}
 
-		if (_forge_shader_description_init(forge, name, shader_source_code, shader) == false)
+		return _forge_shader_description_init(forge, name, shader_source_code, shader);
+	}
+
+	static bool
+	_forge_compute_shader_compile(Forge* forge, const char* name, const char* shader_source_code, ForgeShader* shader)
+	{
+		if (_forge_shader_spirv_init(forge, FORGE_SHADER_STAGE_COMPUTE, name, shader_source_code, shader) == false)
 		{
 			return false;
 		}
 
+		return _forge_compute_shader_description_init(forge, name, shader);
+	}
+
+	static bool
+	_forge_shader_archive_stage_init(Forge* forge, ForgeShaderArchive* archive, const char* name, uint64_t variant, FORGE_SHADER_STAGE stage, ForgeShader* shader)
+	{
+		auto entry = forge_shader_archive_find(forge, archive, name, variant, stage);
+		if (entry == nullptr)
+		{
+			log_error("The shader archive doesn't hold the '{}' stage of the shader '{}'", _forge_shader_stage_macro(stage), name);
+			return false;
+		}
+
+		if (forge_shader_reflection_deserialize(forge, archive->data + entry->reflection_offset, entry->reflection_size, &shader->reflections[stage]) == false)
+		{
+			log_error("The reflection record of the shader '{}' is corrupted", name);
+			return false;
+		}
+
+		// No copy, the module is created straight out of the mapping
+		auto code = (const uint32_t*)(archive->data + entry->spirv_offset);
+		shader->description.name = name;
+
+		return _forge_shader_module_init(forge, stage, code, entry->spirv_size, shader);
+	}
+
+	// Creates the Vulkan objects out of the compiled and reflected shader
+	static bool
+	_forge_shader_objects_init(Forge* forge, ForgeShader* shader)
+	{
+		for (uint32_t i = 0; i < FORGE_SHADER_STAGE_COUNT; ++i)
+		{
+			// Modules loaded out of an archive are already created
+			if (shader->modules[i] || shader->spirv[i].empty())
+				continue;
+
+			auto& spirv = shader->spirv[i];
+			if (_forge_shader_module_init(forge, (FORGE_SHADER_STAGE)i, spirv.data(), spirv.size() * sizeof(uint32_t), shader) == false)
+			{
+				return false;
+			}
+		}
+
 		if (_forge_shader_descriptor_set_layout_init(forge, shader) == false)
 		{
 			return false;
@@ -463,25 +757,68 @@ namespace forge
 			return false;
 		}
 
+		if (_forge_shader_descriptor_update_templates_init(forge, shader) == false)
+		{
+			return false;
+		}
+
+		if (shader->modules[FORGE_SHADER_STAGE_COMPUTE] && _forge_shader_compute_pipeline_init(forge, shader) == false)
+		{
+			return false;
+		}
+
 		return true;
 	}
 
-	static void
-	_forge_shader_free(Forge* forge, ForgeShader* shader)
+	static bool
+	_forge_shader_init(Forge* forge, ForgePipelineDescription pipeline_description, const char* name, const char* shader_source_code, ForgeShader* shader)
 	{
-		if (shader->modules[FORGE_SHADER_STAGE_FRAGMENT])
+		if (_forge_shader_compile(forge, name, shader_source_code, shader) == false)
 		{
-			forge_deletion_queue_push(forge, forge->deletion_queue, shader->modules[FORGE_SHADER_STAGE_FRAGMENT]);
+			return false;
 		}
 
-		if (shader->modules[FORGE_SHADER_STAGE_VERTEX])
+		return _forge_shader_objects_init(forge, shader);
+	}
+
+	static bool
+	_forge_compute_shader_init(Forge* forge, const char* name, const char* shader_source_code, ForgeShader* shader)
+	{
+		if (_forge_compute_shader_compile(forge, name, shader_source_code, shader) == false)
 		{
-			forge_deletion_queue_push(forge, forge->deletion_queue, shader->modules[FORGE_SHADER_STAGE_VERTEX]);
+			return false;
 		}
 
-		if (shader->descriptor_set_layout)
+		return _forge_shader_objects_init(forge, shader);
+	}
+
+	static void
+	_forge_shader_free(Forge* forge, ForgeShader* shader)
+	{
+		// Background jobs write into the shader and build pipelines out of its modules and layouts, they have to be done
+		// before any of it is queued for deletion since a flush on another thread could destroy it right away
+		std::unique_lock<std::mutex> lock(shader->mutex);
+		shader->pipelines_compiled.wait(lock, [shader]() { return shader->pipelines_compiling == 0u; });
+
+		for (uint32_t i = 0; i < FORGE_SHADER_STAGE_COUNT; ++i)
 		{
-			forge_deletion_queue_push(forge, forge->deletion_queue, shader->descriptor_set_layout);
+			if (shader->modules[i])
+			{
+				forge_deletion_queue_push(forge, forge->deletion_queue, shader->modules[i]);
+			}
+		}
+
+		for (uint32_t i = 0; i < FORGE_SHADER_MAX_SETS; ++i)
+		{
+			if (shader->descriptor_update_templates[i])
+			{
+				forge_deletion_queue_push(forge, forge->deletion_queue, shader->descriptor_update_templates[i]);
+			}
+
+			if (shader->descriptor_set_layouts[i])
+			{
+				forge_deletion_queue_push(forge, forge->deletion_queue, shader->descriptor_set_layouts[i]);
+			}
 		}
 
 		if (shader->pipeline_layout)
@@ -493,6 +830,114 @@ namespace forge
 		{
 			forge_deletion_queue_push(forge, forge->deletion_queue, shader->pipeline);
 		}
+
+		for (auto& [key, pipeline] : shader->pipelines)
+		{
+			if (pipeline.handle)
+			{
+				forge_deletion_queue_push(forge, forge->deletion_queue, pipeline.handle);
+			}
+		}
+		shader->pipelines.clear();
+	}
+
+	static uint64_t
+	_forge_shader_pipeline_key(ForgeShader* shader, ForgeRenderPass* pass)
+	{
+		uint64_t key = shader->pipeline_description_hash;
+		_forge_hash_combine(key, pass->compatibility_hash);
+
+		return key;
+	}
+
+	static void
+	_forge_shader_pipeline_compile(Forge* forge, ForgeShader* shader, uint64_t key, VkRenderPass pass)
+	{
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		auto compiled = _forge_shader_pipeline_init(forge, shader, pass, &pipeline);
+
+		{
+			std::lock_guard<std::mutex> lock(shader->mutex);
+
+			auto& entry = shader->pipelines[key];
+			entry.handle = pipeline;
+			entry.state = compiled ? FORGE_SHADER_PIPELINE_STATE_READY : FORGE_SHADER_PIPELINE_STATE_FAILED;
+			--shader->pipelines_compiling;
+
+			if (compiled)
+			{
+				log_info("Shader '{}' compiled its '{}' graphics pipeline", shader->description.name, shader->pipelines.size());
+			}
+			else
+			{
+				log_error("Shader '{}' failed to compile a graphics pipeline, draws using it with that pass are skipped", shader->description.name);
+			}
+		}
+		shader->pipelines_compiled.notify_all();
+	}
+
+	FORGE_SHADER_PIPELINE_STATE
+	forge_shader_pipeline_request(Forge* forge, ForgeShader* shader, ForgeRenderPass* pass)
+	{
+		auto key = _forge_shader_pipeline_key(shader, pass);
+
+		{
+			std::lock_guard<std::mutex> lock(shader->mutex);
+
+			auto iter = shader->pipelines.find(key);
+			if (iter != shader->pipelines.end())
+			{
+				return iter->second.state;
+			}
+
+			shader->pipelines[key] = ForgeShaderPipeline{VK_NULL_HANDLE, FORGE_SHADER_PIPELINE_STATE_COMPILING};
+			++shader->pipelines_compiling;
+		}
+
+		// Jobs compile against a compatible pass of their own, the pass can be recreated or destroyed meanwhile without
+		// waiting for them
+		auto compatible_pass = forge->worker_pool ? forge_render_pass_compatible_new(forge, pass) : VK_NULL_HANDLE;
+		if (compatible_pass)
+		{
+			forge_worker_pool_push(forge, forge->worker_pool, [forge, shader, key, compatible_pass]() {
+				_forge_shader_pipeline_compile(forge, shader, key, compatible_pass);
+
+				// Pipelines don't keep a reference to the pass they were created with
+				vkDestroyRenderPass(forge->device, compatible_pass, nullptr);
+			});
+
+			return FORGE_SHADER_PIPELINE_STATE_COMPILING;
+		}
+
+		_forge_shader_pipeline_compile(forge, shader, key, pass->handle);
+
+		std::lock_guard<std::mutex> lock(shader->mutex);
+		return shader->pipelines[key].state;
+	}
+
+	VkPipeline
+	forge_shader_pipeline_get(Forge* forge, ForgeShader* shader, ForgeRenderPass* pass)
+	{
+		if (forge_shader_pipeline_request(forge, shader, pass) != FORGE_SHADER_PIPELINE_STATE_READY)
+		{
+			return VK_NULL_HANDLE;
+		}
+
+		std::lock_guard<std::mutex> lock(shader->mutex);
+		return shader->pipelines[_forge_shader_pipeline_key(shader, pass)].handle;
+	}
+
+	VkPipeline
+	forge_shader_pipeline_wait(Forge* forge, ForgeShader* shader, ForgeRenderPass* pass)
+	{
+		forge_shader_pipeline_request(forge, shader, pass);
+
+		auto key = _forge_shader_pipeline_key(shader, pass);
+
+		std::unique_lock<std::mutex> lock(shader->mutex);
+		shader->pipelines_compiled.wait(lock, [shader, key]() { return shader->pipelines[key].state != FORGE_SHADER_PIPELINE_STATE_COMPILING; });
+
+		return shader->pipelines[key].handle;
 	}
 
 	ForgeShader*
@@ -500,6 +945,8 @@ namespace forge
 	{
 		ForgeShader* shader = new ForgeShader();
 		shader->pipeline_description = pipeline_description;
+		// Only made of 32 bit fields so there's no padding to worry about, the vertex layout is part of it
+		shader->pipeline_description_hash = _forge_hash_bytes(&pipeline_description, sizeof(pipeline_description));
 
 		if (_forge_shader_init(forge, pipeline_description, name, shader_source_code, shader) == false)
 		{
@@ -510,6 +957,118 @@ namespace forge
 		return shader;
 	}
 
+	ForgeShader*
+	forge_shader_new(Forge* forge, ForgePipelineDescription pipeline_description, ForgeShaderArchive* archive, const char* name, uint64_t variant)
+	{
+		ForgeShader* shader = new ForgeShader();
+		shader->pipeline_description = pipeline_description;
+		shader->pipeline_description_hash = _forge_hash_bytes(&pipeline_description, sizeof(pipeline_description));
+
+		bool loaded = _forge_shader_archive_stage_init(forge, archive, name, variant, FORGE_SHADER_STAGE_VERTEX, shader) &&
+			_forge_shader_archive_stage_init(forge, archive, name, variant, FORGE_SHADER_STAGE_FRAGMENT, shader) &&
+			_forge_shader_description_init(forge, name, nullptr, shader) &&
+			_forge_shader_objects_init(forge, shader);
+
+		if (loaded == false)
+		{
+			forge_shader_destroy(forge, shader);
+			return nullptr;
+		}
+
+		return shader;
+	}
+
+	ForgeShader*
+	forge_compute_shader_new(Forge* forge, const char* name, const char* shader_source_code)
+	{
+		ForgeShader* shader = new ForgeShader();
+
+		if (_forge_compute_shader_init(forge, name, shader_source_code, shader) == false)
+		{
+			forge_shader_destroy(forge, shader);
+			return nullptr;
+		}
+
+		return shader;
+	}
+
+	ForgeShader*
+	forge_compute_shader_new(Forge* forge, ForgeShaderArchive* archive, const char* name, uint64_t variant)
+	{
+		ForgeShader* shader = new ForgeShader();
+
+		bool loaded = _forge_shader_archive_stage_init(forge, archive, name, variant, FORGE_SHADER_STAGE_COMPUTE, shader) &&
+			_forge_compute_shader_description_init(forge, name, shader) &&
+			_forge_shader_objects_init(forge, shader);
+
+		if (loaded == false)
+		{
+			forge_shader_destroy(forge, shader);
+			return nullptr;
+		}
+
+		return shader;
+	}
+
+	bool
+	forge_shader_new_batch(Forge* forge, const ForgeShaderSource* sources, uint32_t count, uint32_t threads_count, ForgeShader** shaders)
+	{
+		if (threads_count == 0u)
+		{
+			threads_count = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		threads_count = std::min(threads_count, count);
+
+		std::vector<uint8_t> compiled(count, 0u);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			shaders[i] = new ForgeShader();
+			shaders[i]->pipeline_description = sources[i].pipeline_description;
+			shaders[i]->pipeline_description_hash = _forge_hash_bytes(&sources[i].pipeline_description, sizeof(sources[i].pipeline_description));
+			shaders[i]->macros = sources[i].macros;
+			shaders[i]->specialization_entries = sources[i].specialization_entries;
+			shaders[i]->specialization_data = sources[i].specialization_data;
+		}
+
+		// shaderc and spirv-cross dominate, a temporary pool keeps them off the pipeline workers
+		auto pool = threads_count > 1u ? forge_worker_pool_new(forge, threads_count) : nullptr;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			auto job = [forge, sources, shaders, &compiled, i]() {
+				auto& source = sources[i];
+				compiled[i] = source.compute
+					? _forge_compute_shader_compile(forge, source.name, source.source_code, shaders[i])
+					: _forge_shader_compile(forge, source.name, source.source_code, shaders[i]);
+			};
+
+			if (pool)
+			{
+				forge_worker_pool_push(forge, pool, job);
+			}
+			else
+			{
+				job();
+			}
+		}
+		forge_worker_pool_destroy(forge, pool);
+
+		bool result = true;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (compiled[i] == 0u || _forge_shader_objects_init(forge, shaders[i]) == false)
+			{
+				log_error("Failed to create the shader '{}' of the batch", sources[i].name);
+				forge_shader_destroy(forge, shaders[i]);
+				shaders[i] = nullptr;
+				result = false;
+			}
+		}
+
+		log_info("A batch of '{}' shaders was compiled on '{}' threads", count, std::max(threads_count, 1u));
+
+		return result;
+	}
+
 	void
 	forge_shader_destroy(Forge* forge, ForgeShader* shader)
 	{
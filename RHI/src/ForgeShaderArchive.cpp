@@ -0,0 +1,279 @@
+#include "Forge.h"
+#include "ForgeShaderArchive.h"
+#include "ForgeLogger.h"
+#include "ForgeUtils.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace forge
+{
+	static bool
+	_forge_shader_archive_entry_less(const ForgeShaderArchiveEntry& entry, uint64_t key, uint32_t stage)
+	{
+		return entry.key < key || (entry.key == key && entry.stage < stage);
+	}
+
+	static bool
+	_forge_shader_archive_map(const char* path, ForgeShaderArchive* archive)
+	{
+#ifdef _WIN32
+		auto file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+		archive->file = file;
+
+		LARGE_INTEGER size{};
+		if (GetFileSizeEx(file, &size) == FALSE || size.QuadPart == 0)
+			return false;
+
+		archive->mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0u, 0u, nullptr);
+		if (archive->mapping == nullptr)
+			return false;
+
+		archive->data = (const uint8_t*)MapViewOfFile(archive->mapping, FILE_MAP_READ, 0u, 0u, 0u);
+		archive->size = (size_t)size.QuadPart;
+#else
+		auto file = open(path, O_RDONLY);
+		if (file < 0)
+			return false;
+
+		struct stat info{};
+		if (fstat(file, &info) != 0 || info.st_size == 0)
+		{
+			close(file);
+			return false;
+		}
+
+		// The mapping stays valid once the descriptor is closed
+		auto data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+
+		if (data == MAP_FAILED)
+			return false;
+
+		archive->data = (const uint8_t*)data;
+		archive->size = (size_t)info.st_size;
+#endif
+
+		return archive->data != nullptr;
+	}
+
+	static bool
+	_forge_shader_archive_validate(ForgeShaderArchive* archive)
+	{
+		if (archive->size < sizeof(ForgeShaderArchiveHeader))
+			return false;
+
+		archive->header = (const ForgeShaderArchiveHeader*)archive->data;
+		archive->entries = (const ForgeShaderArchiveEntry*)(archive->data + sizeof(ForgeShaderArchiveHeader));
+
+		auto& header = *archive->header;
+		if (header.magic != FORGE_SHADER_ARCHIVE_MAGIC || header.version != FORGE_SHADER_ARCHIVE_VERSION)
+			return false;
+
+		if (sizeof(ForgeShaderArchiveHeader) + (size_t)header.entries_count * sizeof(ForgeShaderArchiveEntry) > archive->size)
+			return false;
+
+		// Checked once here so lookups can trust the offsets
+		for (uint32_t i = 0; i < header.entries_count; ++i)
+		{
+			auto& entry = archive->entries[i];
+			// Shader modules are created straight out of the mapping, their size has to be valid SPIR-V words
+			if (entry.spirv_size == 0u || entry.spirv_size % sizeof(uint32_t) != 0u)
+				return false;
+
+			if (entry.spirv_offset % sizeof(uint32_t) != 0u || (size_t)entry.spirv_offset + entry.spirv_size > archive->size)
+				return false;
+
+			// Even a record without resources holds its header
+			if (entry.reflection_size == 0u || (size_t)entry.reflection_offset + entry.reflection_size > archive->size)
+				return false;
+
+			// Lookups are a binary search, entries out of order or held twice would be missed
+			if (i > 0u && _forge_shader_archive_entry_less(archive->entries[i - 1], entry.key, entry.stage) == false)
+				return false;
+		}
+
+		return true;
+	}
+
+	static bool
+	_forge_shader_archive_init(Forge* forge, const char* path, ForgeShaderArchive* archive)
+	{
+		if (_forge_shader_archive_map(path, archive) == false)
+		{
+			log_error("Failed to map the shader archive '{}'", path);
+			return false;
+		}
+
+		if (_forge_shader_archive_validate(archive) == false)
+		{
+			log_error("The shader archive '{}' is corrupted or was written by another version", path);
+			return false;
+		}
+
+		log_info("The shader archive '{}' was mapped with '{}' entries", path, archive->header->entries_count);
+
+		return true;
+	}
+
+	static void
+	_forge_shader_archive_free(Forge* forge, ForgeShaderArchive* archive)
+	{
+#ifdef _WIN32
+		if (archive->data)
+		{
+			UnmapViewOfFile(archive->data);
+		}
+
+		if (archive->mapping)
+		{
+			CloseHandle(archive->mapping);
+		}
+
+		if (archive->file && archive->file != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(archive->file);
+		}
+#else
+		if (archive->data)
+		{
+			munmap((void*)archive->data, archive->size);
+		}
+#endif
+	}
+
+	ForgeShaderArchive*
+	forge_shader_archive_new(Forge* forge, const char* path)
+	{
+		auto archive = new ForgeShaderArchive();
+
+		if (_forge_shader_archive_init(forge, path, archive) == false)
+		{
+			forge_shader_archive_destroy(forge, archive);
+			return nullptr;
+		}
+
+		return archive;
+	}
+
+	uint64_t
+	forge_shader_archive_key(const char* name, uint64_t variant)
+	{
+		auto key = _forge_hash_bytes(name, strlen(name));
+		return _forge_hash_bytes(&variant, sizeof(variant), key);
+	}
+
+	const ForgeShaderArchiveEntry*
+	forge_shader_archive_find(Forge* forge, ForgeShaderArchive* archive, const char* name, uint64_t variant, FORGE_SHADER_STAGE stage)
+	{
+		auto key = forge_shader_archive_key(name, variant);
+
+		auto begin = archive->entries;
+		auto end = archive->entries + archive->header->entries_count;
+		auto iter = std::lower_bound(begin, end, key, [stage](const ForgeShaderArchiveEntry& entry, uint64_t value) {
+			return _forge_shader_archive_entry_less(entry, value, (uint32_t)stage);
+		});
+
+		if (iter == end || iter->key != key || iter->stage != (uint32_t)stage)
+			return nullptr;
+
+		return iter;
+	}
+
+	bool
+	forge_shader_archive_write(Forge* forge, const char* path, const std::vector<ForgeShaderArchiveSource>& sources)
+	{
+		std::vector<ForgeShaderArchiveEntry> entries(sources.size());
+		std::vector<std::vector<uint8_t>> reflections(sources.size());
+
+		auto offset = (uint32_t)(sizeof(ForgeShaderArchiveHeader) + entries.size() * sizeof(ForgeShaderArchiveEntry));
+		for (size_t i = 0; i < sources.size(); ++i)
+		{
+			auto& source = sources[i];
+			auto& entry = entries[i];
+
+			forge_shader_reflection_serialize(forge, source.reflection, &reflections[i]);
+
+			entry.key = forge_shader_archive_key(source.name.c_str(), source.variant);
+			entry.stage = (uint32_t)source.stage;
+			entry.spirv_offset = offset;
+			entry.spirv_size = (uint32_t)(source.spirv.size() * sizeof(uint32_t));
+			entry.reflection_offset = entry.spirv_offset + entry.spirv_size;
+			entry.reflection_size = (uint32_t)reflections[i].size();
+
+			// The next SPIR-V blob has to stay 4 bytes aligned
+			offset = (uint32_t)_forge_align_up((entry.reflection_offset + entry.reflection_size), sizeof(uint32_t));
+		}
+
+		// Sorting the entries doesn't move the data they point to
+		std::vector<size_t> order(entries.size());
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			order[i] = i;
+		}
+		std::sort(order.begin(), order.end(), [&entries](size_t a, size_t b) {
+			return _forge_shader_archive_entry_less(entries[a], entries[b].key, entries[b].stage);
+		});
+
+		for (size_t i = 1; i < order.size(); ++i)
+		{
+			auto& previous = entries[order[i - 1]];
+			auto& current = entries[order[i]];
+			if (previous.key == current.key && previous.stage == current.stage)
+			{
+				log_error("The shader archive '{}' would hold the shader '{}' twice", path, sources[order[i]].name);
+				return false;
+			}
+		}
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+		ForgeShaderArchiveHeader header{ FORGE_SHADER_ARCHIVE_MAGIC, FORGE_SHADER_ARCHIVE_VERSION, (uint32_t)entries.size(), 0u };
+		file.write((const char*)&header, sizeof(header));
+
+		for (auto i : order)
+		{
+			file.write((const char*)&entries[i], sizeof(ForgeShaderArchiveEntry));
+		}
+
+		const char padding[sizeof(uint32_t)] = {};
+		for (size_t i = 0; i < sources.size(); ++i)
+		{
+			file.write((const char*)sources[i].spirv.data(), entries[i].spirv_size);
+			file.write((const char*)reflections[i].data(), reflections[i].size());
+
+			auto end = entries[i].reflection_offset + entries[i].reflection_size;
+			file.write(padding, _forge_align_up(end, sizeof(uint32_t)) - end);
+		}
+
+		if (file.good() == false)
+		{
+			log_error("Failed to write the shader archive '{}'", path);
+			return false;
+		}
+
+		log_info("The shader archive '{}' was written with '{}' entries", path, entries.size());
+
+		return true;
+	}
+
+	void
+	forge_shader_archive_destroy(Forge* forge, ForgeShaderArchive* archive)
+	{
+		if (archive)
+		{
+			_forge_shader_archive_free(forge, archive);
+			delete archive;
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,253 @@
+#include "Forge.h"
+#include "ForgeShaderCache.h"
+#include "ForgeLogger.h"
+#include "ForgeUtils.h"
+
+#include <fstream>
+#include <filesystem>
+#include <thread>
+
+namespace forge
+{
+	static constexpr uint32_t SPIRV_MAGIC = 0x07230203u;
+
+	static shaderc::CompileOptions
+	_forge_shader_cache_options(const std::vector<std::string>& macros)
+	{
+		shaderc::CompileOptions options;
+		for (auto& macro : macros)
+		{
+			options.AddMacroDefinition(macro);
+		}
+
+		return options;
+	}
+
+	static uint64_t
+	_forge_shader_cache_key(ForgeShaderCache* cache, shaderc_shader_kind kind, const char* source, const std::vector<std::string>& macros)
+	{
+		// Anything that changes _forge_shader_cache_options has to be part of the key as well, macros are hashed with
+		// their terminator so "AB" and "A", "B" don't collide
+		auto key = cache->compiler_hash;
+		key = _forge_hash_bytes(&kind, sizeof(kind), key);
+		for (auto& macro : macros)
+		{
+			key = _forge_hash_bytes(macro.c_str(), macro.size() + 1u, key);
+		}
+		key = _forge_hash_bytes(source, strlen(source), key);
+
+		return key;
+	}
+
+	static std::filesystem::path
+	_forge_shader_cache_entry_path(ForgeShaderCache* cache, uint64_t key, const char* extension)
+	{
+		return std::filesystem::path(cache->directory) / fmt::format("{:016x}.{}", key, extension);
+	}
+
+	static bool
+	_forge_shader_cache_disk_load(ForgeShaderCache* cache, uint64_t key, std::vector<uint32_t>* spirv)
+	{
+		std::error_code error;
+		auto path = _forge_shader_cache_entry_path(cache, key, "spv");
+
+		auto size = std::filesystem::file_size(path, error);
+		if (error || size == 0u || size % sizeof(uint32_t) != 0u)
+			return false;
+
+		std::ifstream file(path, std::ios::binary);
+		spirv->resize(size / sizeof(uint32_t));
+		if (file.read((char*)spirv->data(), size).good() == false || (*spirv)[0] != SPIRV_MAGIC)
+		{
+			log_warning("Shader cache entry '{}' is corrupted and will be recompiled", path.string());
+			spirv->clear();
+			return false;
+		}
+
+		return true;
+	}
+
+	static bool
+	_forge_shader_cache_disk_reflection_load(Forge* forge, ForgeShaderCache* cache, uint64_t key, ForgeShaderReflection* reflection)
+	{
+		std::error_code error;
+		auto path = _forge_shader_cache_entry_path(cache, key, "refl");
+
+		auto size = std::filesystem::file_size(path, error);
+		if (error || size == 0u)
+			return false;
+
+		std::vector<uint8_t> blob(size);
+		std::ifstream file(path, std::ios::binary);
+		if (file.read((char*)blob.data(), size).good() == false || forge_shader_reflection_deserialize(forge, blob.data(), blob.size(), reflection) == false)
+		{
+			log_warning("Shader cache reflection record '{}' is stale or corrupted and will be reflected again", path.string());
+			return false;
+		}
+
+		return true;
+	}
+
+	static void
+	_forge_shader_cache_disk_store(ForgeShaderCache* cache, uint64_t key, const char* extension, const void* data, size_t size)
+	{
+		std::error_code error;
+		auto path = _forge_shader_cache_entry_path(cache, key, extension);
+		// Threads compiling the same source at once must not write into the same temporary file
+		auto temp_path = path;
+		temp_path += fmt::format(".{:x}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+		{
+			std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+			file.write((const char*)data, size);
+
+			if (file.good() == false)
+			{
+				log_warning("Failed to write shader cache entry '{}'", temp_path.string());
+				file.close();
+				std::filesystem::remove(temp_path, error);
+				return;
+			}
+		}
+
+		// Other processes might be reading the same entry, never let them see a partial file
+		std::filesystem::rename(temp_path, path, error);
+		if (error)
+		{
+			log_warning("Failed to store shader cache entry '{}', the following error '{}' is reported", path.string(), error.message());
+			std::filesystem::remove(temp_path, error);
+		}
+	}
+
+	static bool
+	_forge_shader_cache_init(Forge* forge, const std::string& directory, ForgeShaderCache* cache)
+	{
+		unsigned int spv_version = 0u;
+		unsigned int spv_revision = 0u;
+		shaderc_get_spv_version(&spv_version, &spv_revision);
+
+		// shaderc ships with the SDK, the header version is the closest thing to its own version it exposes
+		uint32_t version = FORGE_SHADER_CACHE_VERSION;
+		uint32_t sdk_version = VK_HEADER_VERSION_COMPLETE;
+		cache->compiler_hash = _forge_hash_bytes(&version, sizeof(version));
+		cache->compiler_hash = _forge_hash_bytes(&sdk_version, sizeof(sdk_version), cache->compiler_hash);
+		cache->compiler_hash = _forge_hash_bytes(&spv_version, sizeof(spv_version), cache->compiler_hash);
+		cache->compiler_hash = _forge_hash_bytes(&spv_revision, sizeof(spv_revision), cache->compiler_hash);
+		cache->directory = directory;
+
+		if (cache->directory.empty() == false)
+		{
+			std::error_code error;
+			std::filesystem::create_directories(cache->directory, error);
+
+			if (error)
+			{
+				log_warning("Failed to create shader cache directory '{}', shaders will only be cached in memory", cache->directory);
+				cache->directory.clear();
+			}
+		}
+
+		return true;
+	}
+
+	static void
+	_forge_shader_cache_free(Forge* forge, ForgeShaderCache* cache)
+	{
+		log_info("Shader cache had '{}' memory hits, '{}' disk hits and '{}' misses", cache->memory_hits, cache->disk_hits, cache->misses);
+	}
+
+	ForgeShaderCache*
+	forge_shader_cache_new(Forge* forge, const std::string& directory)
+	{
+		auto cache = new ForgeShaderCache();
+
+		if (_forge_shader_cache_init(forge, directory, cache) == false)
+		{
+			forge_shader_cache_destroy(forge, cache);
+			return nullptr;
+		}
+
+		return cache;
+	}
+
+	bool
+	forge_shader_cache_compile(Forge* forge, ForgeShaderCache* cache, shaderc_shader_kind kind, const char* name, const char* source, const std::vector<std::string>& macros, std::vector<uint32_t>* spirv, ForgeShaderReflection* reflection)
+	{
+		auto key = _forge_shader_cache_key(cache, kind, source, macros);
+
+		{
+			std::lock_guard<std::mutex> lock(cache->mutex);
+
+			auto iter = cache->entries.find(key);
+			if (iter != cache->entries.end())
+			{
+				++cache->memory_hits;
+				*spirv = iter->second.spirv;
+				*reflection = iter->second.reflection;
+				return true;
+			}
+		}
+
+		// Two threads missing on the same key both do the work, they store identical entries
+		bool disk_hit = cache->directory.empty() == false && _forge_shader_cache_disk_load(cache, key, spirv);
+		if (disk_hit == false)
+		{
+			auto options = _forge_shader_cache_options(macros);
+			auto module = cache->compiler.CompileGlslToSpv(source, kind, name, options);
+
+			if (module.GetCompilationStatus() != shaderc_compilation_status_success)
+			{
+				log_error("{}", module.GetErrorMessage().c_str());
+				return false;
+			}
+
+			spirv->assign(module.cbegin(), module.cend());
+
+			if (cache->directory.empty() == false)
+			{
+				_forge_shader_cache_disk_store(cache, key, "spv", spirv->data(), spirv->size() * sizeof(uint32_t));
+			}
+		}
+
+		// The record is only trusted next to the SPIR-V it was made from
+		bool reflection_hit = disk_hit && _forge_shader_cache_disk_reflection_load(forge, cache, key, reflection);
+		if (reflection_hit == false)
+		{
+			if (forge_shader_reflection_init(forge, *spirv, reflection) == false)
+			{
+				log_error("Failed to reflect the shader '{}'", name);
+				return false;
+			}
+
+			if (cache->directory.empty() == false)
+			{
+				std::vector<uint8_t> blob;
+				forge_shader_reflection_serialize(forge, *reflection, &blob);
+				_forge_shader_cache_disk_store(cache, key, "refl", blob.data(), blob.size());
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(cache->mutex);
+		if (disk_hit)
+		{
+			++cache->disk_hits;
+		}
+		else
+		{
+			++cache->misses;
+		}
+		cache->entries[key] = ForgeShaderCacheEntry{ *spirv, *reflection };
+
+		return true;
+	}
+
+	void
+	forge_shader_cache_destroy(Forge* forge, ForgeShaderCache* cache)
+	{
+		if (cache)
+		{
+			_forge_shader_cache_free(forge, cache);
+			delete cache;
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,223 @@
+#include "Forge.h"
+#include "ForgeShaderPermutations.h"
+#include "ForgeLogger.h"
+
+#include <algorithm>
+
+namespace forge
+{
+	static std::string
+	_forge_shader_permutations_variant_name(ForgeShaderPermutations* permutations, uint64_t key)
+	{
+		return fmt::format("{} ({:x})", permutations->description.name, key);
+	}
+
+	static ForgeShaderSource
+	_forge_shader_permutations_source(ForgeShaderPermutations* permutations, uint64_t key, const std::string& name)
+	{
+		auto& description = permutations->description;
+
+		ForgeShaderSource source{};
+		source.name = name.c_str();
+		source.source_code = description.source_code.c_str();
+		source.pipeline_description = description.pipeline_description;
+		source.compute = description.compute;
+
+		// Every specialization constant is provided so the variant doesn't depend on the defaults in the source
+		for (uint32_t i = 0; i < (uint32_t)description.keywords.size(); ++i)
+		{
+			auto& keyword = description.keywords[i];
+			auto enabled = (key >> i) & 1u;
+
+			if (keyword.specialization)
+			{
+				VkSpecializationMapEntry entry{};
+				entry.constantID = keyword.constant_id;
+				entry.offset = (uint32_t)(source.specialization_data.size() * sizeof(uint32_t));
+				entry.size = sizeof(VkBool32);
+				source.specialization_entries.push_back(entry);
+				source.specialization_data.push_back(enabled ? VK_TRUE : VK_FALSE);
+			}
+			else if (enabled)
+			{
+				source.macros.push_back(keyword.name);
+			}
+		}
+
+		return source;
+	}
+
+	static bool
+	_forge_shader_permutations_init(Forge* forge, const ForgeShaderPermutationsDescription& description, ForgeShaderPermutations* permutations)
+	{
+		if (description.keywords.size() > FORGE_SHADER_MAX_KEYWORDS)
+		{
+			log_error("The shader permutations '{}' declare '{}' keywords, at most '{}' are supported", description.name, description.keywords.size(), FORGE_SHADER_MAX_KEYWORDS);
+			return false;
+		}
+
+		// Keys are built by name and specialization info can't map a constant twice
+		auto& keywords = description.keywords;
+		for (size_t i = 0; i < keywords.size(); ++i)
+		{
+			for (size_t j = 0; j < i; ++j)
+			{
+				if (keywords[i].name == keywords[j].name)
+				{
+					log_error("The shader permutations '{}' declare the keyword '{}' twice", description.name, keywords[i].name);
+					return false;
+				}
+
+				if (keywords[i].specialization && keywords[j].specialization && keywords[i].constant_id == keywords[j].constant_id)
+				{
+					log_error("The shader permutations '{}' map the keywords '{}' and '{}' to the same constant id '{}'", description.name, keywords[j].name, keywords[i].name, keywords[i].constant_id);
+					return false;
+				}
+			}
+		}
+
+		permutations->description = description;
+
+		auto keywords_count = (uint32_t)description.keywords.size();
+		permutations->keywords_mask = keywords_count == FORGE_SHADER_MAX_KEYWORDS ? ~0ull : (1ull << keywords_count) - 1ull;
+
+		return true;
+	}
+
+	static void
+	_forge_shader_permutations_free(Forge* forge, ForgeShaderPermutations* permutations)
+	{
+		for (auto& [key, shader] : permutations->variants)
+		{
+			forge_shader_destroy(forge, shader);
+		}
+		permutations->variants.clear();
+	}
+
+	ForgeShaderPermutations*
+	forge_shader_permutations_new(Forge* forge, const ForgeShaderPermutationsDescription& description)
+	{
+		auto permutations = new ForgeShaderPermutations();
+
+		if (_forge_shader_permutations_init(forge, description, permutations) == false)
+		{
+			forge_shader_permutations_destroy(forge, permutations);
+			return nullptr;
+		}
+
+		return permutations;
+	}
+
+	uint64_t
+	forge_shader_permutations_key(Forge* forge, ForgeShaderPermutations* permutations, const std::vector<std::string>& keywords)
+	{
+		auto& declared = permutations->description.keywords;
+
+		uint64_t key = 0u;
+		for (auto& keyword : keywords)
+		{
+			auto iter = std::find_if(declared.begin(), declared.end(), [&keyword](const ForgeShaderKeyword& other) {
+				return other.name == keyword;
+			});
+
+			if (iter == declared.end())
+			{
+				log_warning("The shader permutations '{}' don't declare the keyword '{}'", permutations->description.name, keyword);
+				continue;
+			}
+
+			key |= 1ull << (uint64_t)(iter - declared.begin());
+		}
+
+		return key;
+	}
+
+	ForgeShader*
+	forge_shader_permutations_get(Forge* forge, ForgeShaderPermutations* permutations, uint64_t key)
+	{
+		key &= permutations->keywords_mask;
+
+		std::lock_guard<std::mutex> lock(permutations->mutex);
+
+		auto iter = permutations->variants.find(key);
+		if (iter != permutations->variants.end())
+		{
+			return iter->second;
+		}
+
+		// Compiled on the calling thread, a batch of one doesn't spin up any worker
+		auto name = _forge_shader_permutations_variant_name(permutations, key);
+		auto source = _forge_shader_permutations_source(permutations, key, name);
+
+		// A failure is recorded as well, the errors were reported once and compiling again would fail the same way
+		ForgeShader* shader = nullptr;
+		forge_shader_new_batch(forge, &source, 1u, 1u, &shader);
+		permutations->variants[key] = shader;
+
+		return shader;
+	}
+
+	bool
+	forge_shader_permutations_compile(Forge* forge, ForgeShaderPermutations* permutations, const uint64_t* keys, uint32_t count, uint32_t threads_count)
+	{
+		std::lock_guard<std::mutex> lock(permutations->mutex);
+
+		bool result = true;
+		std::vector<uint64_t> missing_keys;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			auto key = keys[i] & permutations->keywords_mask;
+
+			auto iter = permutations->variants.find(key);
+			if (iter != permutations->variants.end())
+			{
+				result = result && iter->second != nullptr;
+				continue;
+			}
+
+			if (std::find(missing_keys.begin(), missing_keys.end(), key) == missing_keys.end())
+			{
+				missing_keys.push_back(key);
+			}
+		}
+
+		if (missing_keys.empty())
+			return result;
+
+		// Sources point into the names, they have to outlive the batch
+		std::vector<std::string> names;
+		std::vector<ForgeShaderSource> sources;
+		for (auto key : missing_keys)
+		{
+			names.push_back(_forge_shader_permutations_variant_name(permutations, key));
+		}
+		for (size_t i = 0; i < missing_keys.size(); ++i)
+		{
+			sources.push_back(_forge_shader_permutations_source(permutations, missing_keys[i], names[i]));
+		}
+
+		std::vector<ForgeShader*> shaders(missing_keys.size(), nullptr);
+		if (forge_shader_new_batch(forge, sources.data(), (uint32_t)sources.size(), threads_count, shaders.data()) == false)
+		{
+			result = false;
+		}
+
+		// Failed variants are left null so later lookups don't compile them again
+		for (size_t i = 0; i < missing_keys.size(); ++i)
+		{
+			permutations->variants[missing_keys[i]] = shaders[i];
+		}
+
+		return result;
+	}
+
+	void
+	forge_shader_permutations_destroy(Forge* forge, ForgeShaderPermutations* permutations)
+	{
+		if (permutations)
+		{
+			_forge_shader_permutations_free(forge, permutations);
+			delete permutations;
+		}
+	}
+};
\ No newline at end of file
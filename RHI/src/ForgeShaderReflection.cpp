@@ -0,0 +1,231 @@
+#include "Forge.h"
+#include "ForgeShaderReflection.h"
+#include "ForgeShader.h"
+#include "ForgeLogger.h"
+
+#include <string.h>
+#include <assert.h>
+
+#ifdef FORGE_SPIRV_CROSS
+#include <spirv-headers/spirv.hpp>
+#include <spirv_cross/spirv_cross.hpp>
+#include <spirv_cross/spirv_common.hpp>
+
+using namespace spirv_cross;
+#endif
+
+namespace forge
+{
+	static constexpr uint32_t FORGE_SHADER_REFLECTION_MAGIC = 0x4C464552u; // "REFL"
+
+#ifdef FORGE_SPIRV_CROSS
+	static VkFormat
+	_forge_spirv_type_vk_format(SPIRType type)
+	{
+		if (type.basetype == SPIRType::BaseType::Float)
+		{
+			if (type.vecsize == 1)
+			{
+				return VK_FORMAT_R32_SFLOAT;
+			}
+			else if (type.vecsize == 2)
+			{
+				return VK_FORMAT_R32G32_SFLOAT;
+			}
+			else if (type.vecsize == 3)
+			{
+				return VK_FORMAT_R32G32B32_SFLOAT;
+			}
+			else if (type.vecsize == 4)
+			{
+				return VK_FORMAT_R32G32B32A32_SFLOAT;
+			}
+			else
+			{
+				assert(false); // unreachable
+			}
+		}
+
+		return VK_FORMAT_R8G8B8A8_UNORM;
+	}
+
+	static ForgeShaderReflectionResource
+	_forge_shader_reflection_resource(const Compiler& compiler, const Resource& spv_resource, FORGE_SHADER_REFLECTION_KIND kind)
+	{
+		ForgeShaderReflectionResource resource{};
+		resource.name = spv_resource.name;
+		resource.kind = kind;
+		resource.set = compiler.get_decoration(spv_resource.id, spv::DecorationDescriptorSet);
+		resource.binding = compiler.get_decoration(spv_resource.id, spv::DecorationBinding);
+
+		return resource;
+	}
+#endif
+
+	static void
+	_forge_shader_reflection_write(std::vector<uint8_t>* blob, const void* data, size_t size)
+	{
+		auto offset = blob->size();
+		blob->resize(offset + size);
+		memcpy(blob->data() + offset, data, size);
+	}
+
+	static bool
+	_forge_shader_reflection_read(const uint8_t* data, size_t size, size_t* cursor, void* value, size_t value_size)
+	{
+		if (*cursor + value_size > size)
+			return false;
+
+		memcpy(value, data + *cursor, value_size);
+		*cursor += value_size;
+
+		return true;
+	}
+
+	bool
+	forge_shader_reflection_init(Forge* forge, const std::vector<uint32_t>& spirv, ForgeShaderReflection* reflection)
+	{
+#ifdef FORGE_SPIRV_CROSS
+		// A single parse and a single resource query per stage, every resource kind is read out of the same result
+		Compiler compiler(spirv);
+		auto resources = compiler.get_shader_resources();
+
+		reflection->resources.clear();
+
+		for (auto& input : resources.stage_inputs)
+		{
+			ForgeShaderReflectionResource resource{};
+			resource.name = input.name;
+			resource.kind = FORGE_SHADER_REFLECTION_KIND_INPUT;
+			resource.binding = compiler.get_decoration(input.id, spv::DecorationLocation);
+			resource.value = (uint32_t)_forge_spirv_type_vk_format(compiler.get_type(input.type_id));
+			reflection->resources.push_back(resource);
+		}
+
+		for (auto& spv_uniform : resources.uniform_buffers)
+		{
+			auto resource = _forge_shader_reflection_resource(compiler, spv_uniform, FORGE_SHADER_REFLECTION_KIND_UNIFORM_BUFFER);
+			resource.size = (uint32_t)compiler.get_declared_struct_size(compiler.get_type(spv_uniform.type_id));
+			reflection->resources.push_back(resource);
+		}
+
+		for (auto& spv_image : resources.sampled_images)
+		{
+			// The bindless table is an unsized array, it isn't part of the shader's own layouts
+			auto& type = compiler.get_type(spv_image.type_id);
+			auto unsized = type.array.size() == 1 && type.array[0] == 0u;
+
+			auto kind = unsized ? FORGE_SHADER_REFLECTION_KIND_BINDLESS_TABLE : FORGE_SHADER_REFLECTION_KIND_SAMPLED_IMAGE;
+			reflection->resources.push_back(_forge_shader_reflection_resource(compiler, spv_image, kind));
+		}
+
+		for (auto& spv_image : resources.storage_images)
+		{
+			reflection->resources.push_back(_forge_shader_reflection_resource(compiler, spv_image, FORGE_SHADER_REFLECTION_KIND_STORAGE_IMAGE));
+		}
+
+		for (auto& spv_buffer : resources.storage_buffers)
+		{
+			auto resource = _forge_shader_reflection_resource(compiler, spv_buffer, FORGE_SHADER_REFLECTION_KIND_STORAGE_BUFFER);
+			resource.size = (uint32_t)compiler.get_declared_struct_size(compiler.get_type(spv_buffer.base_type_id));
+			resource.value = compiler.get_buffer_block_flags(spv_buffer.id).get(spv::DecorationNonWritable) ? 1u : 0u;
+			reflection->resources.push_back(resource);
+		}
+
+		for (auto& spv_block : resources.push_constant_buffers)
+		{
+			ForgeShaderReflectionResource resource{};
+			resource.name = spv_block.name;
+			resource.kind = FORGE_SHADER_REFLECTION_KIND_PUSH_CONSTANTS;
+			resource.size = (uint32_t)compiler.get_declared_struct_size(compiler.get_type(spv_block.base_type_id));
+			reflection->resources.push_back(resource);
+		}
+
+		return true;
+#else
+		log_error("Forge was built without spirv-cross, shaders can only be reflected through records stored in the shader cache");
+		return false;
+#endif
+	}
+
+	void
+	forge_shader_reflection_serialize(Forge* forge, const ForgeShaderReflection& reflection, std::vector<uint8_t>* blob)
+	{
+		uint32_t header[3] = { FORGE_SHADER_REFLECTION_MAGIC, FORGE_SHADER_REFLECTION_VERSION, (uint32_t)reflection.resources.size() };
+
+		blob->clear();
+		_forge_shader_reflection_write(blob, header, sizeof(header));
+
+		for (auto& resource : reflection.resources)
+		{
+			uint32_t fields[6] = { (uint32_t)resource.kind, resource.set, resource.binding, resource.size, resource.value, (uint32_t)resource.name.size() };
+			_forge_shader_reflection_write(blob, fields, sizeof(fields));
+			_forge_shader_reflection_write(blob, resource.name.data(), resource.name.size());
+		}
+	}
+
+	// Push constants and the bindless table aren't addressed by binding
+	static uint32_t
+	_forge_shader_reflection_binding_limit(FORGE_SHADER_REFLECTION_KIND kind)
+	{
+		switch (kind)
+		{
+		case FORGE_SHADER_REFLECTION_KIND_INPUT:	return FORGE_SHADER_MAX_INPUT_ATTRIBUTES;
+		case FORGE_SHADER_REFLECTION_KIND_UNIFORM_BUFFER:	return FORGE_SHADER_MAX_DYNAMIC_UNIFORM_BUFFERS;
+		case FORGE_SHADER_REFLECTION_KIND_SAMPLED_IMAGE:	return FORGE_SHADER_MAX_IMAGES;
+		case FORGE_SHADER_REFLECTION_KIND_STORAGE_IMAGE:	return FORGE_SHADER_MAX_IMAGES;
+		case FORGE_SHADER_REFLECTION_KIND_STORAGE_BUFFER:	return FORGE_SHADER_MAX_STORAGE_BUFFERS;
+		default:
+			break;
+		}
+
+		return UINT32_MAX;
+	}
+
+	bool
+	forge_shader_reflection_deserialize(Forge* forge, const uint8_t* data, size_t size, ForgeShaderReflection* reflection)
+	{
+		size_t cursor = 0u;
+
+		uint32_t header[3];
+		if (_forge_shader_reflection_read(data, size, &cursor, header, sizeof(header)) == false)
+			return false;
+
+		if (header[0] != FORGE_SHADER_REFLECTION_MAGIC || header[1] != FORGE_SHADER_REFLECTION_VERSION)
+			return false;
+
+		// Every resource takes at least its fields, a corrupted count must not turn into a huge allocation
+		if ((size_t)header[2] * sizeof(uint32_t) * 6u > size - cursor)
+			return false;
+
+		reflection->resources.resize(header[2]);
+
+		for (auto& resource : reflection->resources)
+		{
+			uint32_t fields[6];
+			if (_forge_shader_reflection_read(data, size, &cursor, fields, sizeof(fields)) == false)
+				return false;
+
+			// The record indexes fixed size arrays once applied, a corrupted one must not get that far
+			if (fields[0] >= FORGE_SHADER_REFLECTION_KIND_COUNT || fields[1] >= FORGE_SHADER_MAX_SETS)
+				return false;
+
+			resource.kind = (FORGE_SHADER_REFLECTION_KIND)fields[0];
+			if (fields[2] >= _forge_shader_reflection_binding_limit(resource.kind))
+				return false;
+
+			resource.set = fields[1];
+			resource.binding = fields[2];
+			resource.size = fields[3];
+			resource.value = fields[4];
+
+			if (cursor + fields[5] > size)
+				return false;
+
+			resource.name.assign((const char*)data + cursor, fields[5]);
+			cursor += fields[5];
+		}
+
+		return cursor == size;
+	}
+};
\ No newline at end of file
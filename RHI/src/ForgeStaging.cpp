@@ -0,0 +1,253 @@
+#include "Forge.h"
+#include "ForgeStaging.h"
+#include "ForgeBuffer.h"
+#include "ForgeLogger.h"
+#include "ForgeUtils.h"
+#include "ForgeDeletionQueue.h"
+
+namespace forge
+{
+	static void
+	_forge_staging_region_begin(Forge* forge, ForgeStaging* staging, ForgeStagingRegion* region)
+	{
+		VkResult res;
+
+		// Only blocks if the ring wrapped around to a region the GPU is still copying from
+		forge_staging_wait(forge, staging, region->release_signal);
+
+		VkCommandBufferBeginInfo begin_info{};
+		begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		res = vkBeginCommandBuffer(region->command_buffer, &begin_info);
+		VK_RES_CHECK(res);
+
+		region->cursor = 0u;
+		region->recording = true;
+	}
+
+	static bool
+	_forge_staging_init(Forge* forge, uint32_t size, ForgeStaging* staging)
+	{
+		VkResult res;
+
+		ForgeBufferDescription desc {};
+		desc.name = "Forge staging buffer";
+		desc.size = size;
+		desc.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		desc.memory_properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		staging->buffer = forge_buffer_new(forge, desc);
+		if (staging->buffer == nullptr)
+		{
+			return false;
+		}
+
+		VkCommandPoolCreateInfo pool_info{};
+		pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		pool_info.queueFamilyIndex = forge->queue_family_index;
+		pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		res = vkCreateCommandPool(forge->device, &pool_info, nullptr, &staging->pool);
+		VK_RES_CHECK(res);
+
+		if (res != VK_SUCCESS)
+		{
+			log_error("Failed to create the staging command pool");
+			return false;
+		}
+
+		VkSemaphoreTypeCreateInfo timeline_info {};
+		timeline_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		timeline_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		timeline_info.initialValue = 0;
+
+		VkSemaphoreCreateInfo semaphore_info {};
+		semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphore_info.pNext = &timeline_info;
+		res = vkCreateSemaphore(forge->device, &semaphore_info, nullptr, &staging->timeline);
+		VK_RES_CHECK(res);
+
+		if (res != VK_SUCCESS)
+		{
+			log_error("Failed to create the staging timeline semaphore");
+			return false;
+		}
+
+		_forge_debug_obj_name_set(forge, (uint64_t)staging->timeline, VK_OBJECT_TYPE_SEMAPHORE, "Forge staging timeline");
+
+		staging->region_size = staging->buffer->description.size / FORGE_STAGING_MAX_REGIONS;
+		staging->timeline_next_signal = 1u;
+		staging->timeline_submitted_signal = 0u;
+		staging->current = 0u;
+
+		for (uint32_t i = 0; i < FORGE_STAGING_MAX_REGIONS; ++i)
+		{
+			auto& region = staging->regions[i];
+			region.offset = i * staging->region_size;
+			region.cursor = 0u;
+			region.release_signal = 0u;
+			region.recording = false;
+
+			VkCommandBufferAllocateInfo alloc_info {};
+			alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			alloc_info.commandBufferCount = 1u;
+			alloc_info.commandPool = staging->pool;
+			alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			res = vkAllocateCommandBuffers(forge->device, &alloc_info, &region.command_buffer);
+			VK_RES_CHECK(res);
+
+			if (res != VK_SUCCESS)
+			{
+				log_error("Failed to allocate the staging command buffers");
+				return false;
+			}
+		}
+
+		log_info("A '{}' bytes staging ring with '{}' regions was created successfully", staging->buffer->description.size, FORGE_STAGING_MAX_REGIONS);
+
+		return true;
+	}
+
+	static void
+	_forge_staging_free(Forge* forge, ForgeStaging* staging)
+	{
+		if (staging->pool)
+		{
+			forge_deletion_queue_push(forge, forge->deletion_queue, staging->pool);
+		}
+
+		if (staging->timeline)
+		{
+			forge_deletion_queue_push(forge, forge->deletion_queue, staging->timeline);
+		}
+
+		if (staging->buffer)
+		{
+			forge_buffer_destroy(forge, staging->buffer);
+		}
+	}
+
+	ForgeStaging*
+	forge_staging_new(Forge* forge, uint32_t size)
+	{
+		auto staging = new ForgeStaging();
+
+		if (_forge_staging_init(forge, size, staging) == false)
+		{
+			forge_staging_destroy(forge, staging);
+			return nullptr;
+		}
+
+		return staging;
+	}
+
+	VkCommandBuffer
+	forge_staging_reserve(Forge* forge, ForgeStaging* staging, uint32_t size, uint32_t alignment, uint32_t* offset)
+	{
+		assert(size <= staging->region_size);
+
+		auto region = &staging->regions[staging->current];
+		auto aligned_cursor = (region->cursor + alignment - 1u) / alignment * alignment;
+
+		if (region->recording && aligned_cursor + size > staging->region_size)
+		{
+			forge_staging_submit(forge, staging);
+			region = &staging->regions[staging->current];
+		}
+
+		if (region->recording == false)
+		{
+			_forge_staging_region_begin(forge, staging, region);
+		}
+
+		aligned_cursor = (region->cursor + alignment - 1u) / alignment * alignment;
+		*offset = region->offset + aligned_cursor;
+		region->cursor = aligned_cursor + size;
+
+		return region->command_buffer;
+	}
+
+	uint64_t
+	forge_staging_submit(Forge* forge, ForgeStaging* staging)
+	{
+		VkResult res;
+
+		auto region = &staging->regions[staging->current];
+		if (region->recording == false)
+		{
+			return staging->timeline_submitted_signal;
+		}
+
+		res = vkEndCommandBuffer(region->command_buffer);
+		VK_RES_CHECK(res);
+
+		uint64_t signal_value = staging->timeline_next_signal;
+
+		// Copies must not overwrite resources the last submitted frame might still be reading from,
+		// this is a GPU side wait so the CPU keeps going
+		uint64_t wait_value = forge->timeline_next_signal - 1u;
+		VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+		VkTimelineSemaphoreSubmitInfo timeline_info {};
+		timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timeline_info.waitSemaphoreValueCount = 1u;
+		timeline_info.pWaitSemaphoreValues = &wait_value;
+		timeline_info.signalSemaphoreValueCount = 1u;
+		timeline_info.pSignalSemaphoreValues = &signal_value;
+
+		VkSubmitInfo submit_info {};
+		submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submit_info.pNext = &timeline_info;
+		submit_info.waitSemaphoreCount = 1u;
+		submit_info.pWaitSemaphores = &forge->timeline;
+		submit_info.pWaitDstStageMask = &wait_stage;
+		submit_info.commandBufferCount = 1u;
+		submit_info.pCommandBuffers = &region->command_buffer;
+		submit_info.signalSemaphoreCount = 1u;
+		submit_info.pSignalSemaphores = &staging->timeline;
+		res = vkQueueSubmit(forge->queue, 1u, &submit_info, VK_NULL_HANDLE);
+		VK_RES_CHECK(res);
+
+		region->release_signal = signal_value;
+		region->recording = false;
+
+		staging->timeline_submitted_signal = signal_value;
+		++staging->timeline_next_signal;
+		staging->current = (staging->current + 1u) % FORGE_STAGING_MAX_REGIONS;
+
+		return signal_value;
+	}
+
+	bool
+	forge_staging_complete(Forge* forge, ForgeStaging* staging, uint64_t signal)
+	{
+		uint64_t value;
+		auto res = vkGetSemaphoreCounterValue(forge->device, staging->timeline, &value);
+		VK_RES_CHECK(res);
+
+		return value >= signal;
+	}
+
+	void
+	forge_staging_wait(Forge* forge, ForgeStaging* staging, uint64_t signal)
+	{
+		if (forge_staging_complete(forge, staging, signal))
+			return;
+
+		VkSemaphoreWaitInfo wait_info{};
+		wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		wait_info.semaphoreCount = 1;
+		wait_info.pSemaphores = &staging->timeline;
+		wait_info.pValues = &signal;
+		auto res = vkWaitSemaphores(forge->device, &wait_info, UINT64_MAX);
+		VK_RES_CHECK(res);
+	}
+
+	void
+	forge_staging_destroy(Forge* forge, ForgeStaging* staging)
+	{
+		if (staging)
+		{
+			_forge_staging_free(forge, staging);
+			delete staging;
+		}
+	}
+};
\ No newline at end of file
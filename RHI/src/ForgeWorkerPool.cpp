@@ -0,0 +1,109 @@
+#include "Forge.h"
+#include "ForgeWorkerPool.h"
+#include "ForgeLogger.h"
+
+namespace forge
+{
+	static void
+	_forge_worker_pool_thread(ForgeWorkerPool* pool)
+	{
+		while (true)
+		{
+			std::function<void()> job;
+
+			{
+				std::unique_lock<std::mutex> lock(pool->mutex);
+				pool->job_available.wait(lock, [pool]() { return pool->stopping || pool->jobs.empty() == false; });
+
+				if (pool->jobs.empty())
+					return;
+
+				job = std::move(pool->jobs.front());
+				pool->jobs.pop_front();
+				++pool->running;
+			}
+
+			job();
+
+			{
+				std::lock_guard<std::mutex> lock(pool->mutex);
+				--pool->running;
+			}
+			pool->idle.notify_all();
+		}
+	}
+
+	static bool
+	_forge_worker_pool_init(Forge* forge, uint32_t threads_count, ForgeWorkerPool* pool)
+	{
+		pool->running = 0u;
+		pool->stopping = false;
+
+		for (uint32_t i = 0; i < threads_count; ++i)
+		{
+			pool->threads.emplace_back(_forge_worker_pool_thread, pool);
+		}
+
+		log_info("Worker pool with '{}' threads was created successfully", threads_count);
+
+		return true;
+	}
+
+	static void
+	_forge_worker_pool_free(Forge* forge, ForgeWorkerPool* pool)
+	{
+		{
+			std::lock_guard<std::mutex> lock(pool->mutex);
+			pool->stopping = true;
+		}
+		pool->job_available.notify_all();
+
+		for (auto& thread : pool->threads)
+		{
+			thread.join();
+		}
+
+		pool->threads.clear();
+	}
+
+	ForgeWorkerPool*
+	forge_worker_pool_new(Forge* forge, uint32_t threads_count)
+	{
+		auto pool = new ForgeWorkerPool();
+
+		if (_forge_worker_pool_init(forge, threads_count, pool) == false)
+		{
+			forge_worker_pool_destroy(forge, pool);
+			return nullptr;
+		}
+
+		return pool;
+	}
+
+	void
+	forge_worker_pool_push(Forge* forge, ForgeWorkerPool* pool, std::function<void()> job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(pool->mutex);
+			pool->jobs.push_back(std::move(job));
+		}
+		pool->job_available.notify_one();
+	}
+
+	void
+	forge_worker_pool_wait(Forge* forge, ForgeWorkerPool* pool)
+	{
+		std::unique_lock<std::mutex> lock(pool->mutex);
+		pool->idle.wait(lock, [pool]() { return pool->jobs.empty() && pool->running == 0u; });
+	}
+
+	void
+	forge_worker_pool_destroy(Forge* forge, ForgeWorkerPool* pool)
+	{
+		if (pool)
+		{
+			_forge_worker_pool_free(forge, pool);
+			delete pool;
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include <Forge.h>
+#include <ForgeLogger.h>
+#include <ForgeShader.h>
+#include <ForgeShaderReflection.h>
+#include <ForgeShaderArchive.h>
+
+#include <shaderc/shaderc.hpp>
+
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <string.h>
+
+// Compiles GLSL sources into a shader archive loaded at runtime with the archive overloads of forge_shader_new, so
+// shipping builds neither compile nor reflect shaders.
+//
+// ForgeShaderCompiler <archive> [--compute] [--variant=<key>[:MACRO,...]] [name=]<source.glsl>...
+//
+// Shaders are named after their file unless a name is given, --compute and --variant apply to the source that follows
+// them. A variant is compiled with its macros defined and stored under its key, the same source may be given once per
+// variant. Sources without --variant are stored as variant zero.
+
+inline static bool
+_shader_code_read(const std::string& path, std::string* source_code)
+{
+	std::ifstream shader_file(path);
+	if (shader_file.is_open() == false)
+	{
+		forge::log_error("Failed to open the shader source '{}'", path);
+		return false;
+	}
+
+	std::stringstream stream;
+	stream << shader_file.rdbuf();
+	*source_code = stream.str();
+
+	return true;
+}
+
+inline static const char*
+_shader_stage_macro(forge::FORGE_SHADER_STAGE stage)
+{
+	switch (stage)
+	{
+	case forge::FORGE_SHADER_STAGE_VERTEX:	return "VERTEX_SHADER";
+	case forge::FORGE_SHADER_STAGE_FRAGMENT:	return "FRAGMENT_SHADER";
+	case forge::FORGE_SHADER_STAGE_COMPUTE:	return "COMPUTE_SHADER";
+	default:
+		break;
+	}
+
+	return "";
+}
+
+inline static bool
+_shader_variant_parse(const std::string& argument, uint64_t* variant, std::vector<std::string>* macros)
+{
+	auto separator = argument.find(':');
+	auto key = argument.substr(0, separator);
+
+	char* end = nullptr;
+	*variant = std::strtoull(key.c_str(), &end, 0);
+	if (key.empty() || *end != '\0')
+	{
+		forge::log_error("The variant key '{}' isn't a number", key);
+		return false;
+	}
+
+	macros->clear();
+	if (separator == std::string::npos)
+		return true;
+
+	std::stringstream stream(argument.substr(separator + 1));
+	std::string macro;
+	while (std::getline(stream, macro, ','))
+	{
+		if (macro.empty() == false)
+		{
+			macros->push_back(macro);
+		}
+	}
+
+	return true;
+}
+
+inline static bool
+_shader_stage_compile(shaderc::Compiler& compiler, const std::string& name, const std::string& source_code, forge::FORGE_SHADER_STAGE stage, uint64_t variant, const std::vector<std::string>& macros, forge::ForgeShaderArchiveSource* source)
+{
+	// Unlike the runtime shader cache, offline builds can afford the optimizer
+	shaderc::CompileOptions options;
+	options.AddMacroDefinition(_shader_stage_macro(stage));
+	for (auto& macro : macros)
+	{
+		options.AddMacroDefinition(macro);
+	}
+	options.SetOptimizationLevel(shaderc_optimization_level_performance);
+
+	// The optimizer strips OpName otherwise, reflection records would lose every resource and attribute name
+	options.SetGenerateDebugInfo();
+
+	auto module = compiler.CompileGlslToSpv(source_code, (shaderc_shader_kind)stage, name.c_str(), options);
+	if (module.GetCompilationStatus() != shaderc_compilation_status_success)
+	{
+		forge::log_error("{}", module.GetErrorMessage().c_str());
+		return false;
+	}
+
+	source->name = name;
+	source->variant = variant;
+	source->stage = stage;
+	source->spirv.assign(module.cbegin(), module.cend());
+
+	// No device is needed to reflect nor to write the archive
+	return forge::forge_shader_reflection_init(nullptr, source->spirv, &source->reflection);
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		forge::log_error("Usage: ForgeShaderCompiler <archive> [--compute] [--variant=<key>[:MACRO,...]] [name=]<source.glsl>...");
+		return -1;
+	}
+
+	shaderc::Compiler compiler;
+	std::vector<forge::ForgeShaderArchiveSource> sources;
+
+	bool compute = false;
+	uint64_t variant = 0u;
+	std::vector<std::string> macros;
+	for (int i = 2; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		if (argument == "--compute")
+		{
+			compute = true;
+			continue;
+		}
+
+		if (argument.rfind("--variant=", 0) == 0)
+		{
+			if (_shader_variant_parse(argument.substr(strlen("--variant=")), &variant, &macros) == false)
+				return -1;
+			continue;
+		}
+
+		auto separator = argument.find('=');
+		auto path = separator == std::string::npos ? argument : argument.substr(separator + 1);
+		auto name = separator == std::string::npos ? std::filesystem::path(path).stem().string() : argument.substr(0, separator);
+
+		std::string source_code;
+		if (_shader_code_read(path, &source_code) == false)
+			return -1;
+
+		std::vector<forge::FORGE_SHADER_STAGE> stages;
+		if (compute)
+		{
+			stages = { forge::FORGE_SHADER_STAGE_COMPUTE };
+		}
+		else
+		{
+			stages = { forge::FORGE_SHADER_STAGE_VERTEX, forge::FORGE_SHADER_STAGE_FRAGMENT };
+		}
+
+		for (auto stage : stages)
+		{
+			forge::ForgeShaderArchiveSource source{};
+			if (_shader_stage_compile(compiler, name, source_code, stage, variant, macros, &source) == false)
+			{
+				forge::log_error("Failed to compile the variant '{}' of the shader '{}' from '{}'", variant, name, path);
+				return -1;
+			}
+
+			sources.push_back(std::move(source));
+		}
+
+		forge::log_info("The variant '{}' of the shader '{}' was compiled from '{}'", variant, name, path);
+		compute = false;
+		variant = 0u;
+		macros.clear();
+	}
+
+	if (forge::forge_shader_archive_write(nullptr, argv[1], sources) == false)
+		return -1;
+
+	return 0;
+}
\ No newline at end of file